@@ -15,6 +15,8 @@
 #include "CANHandler.h"
 #include "networkboot.h"
 #include "calibration_manager.h"
+#include <controllerSnapshot.h>
+#include <metricsLog.h>
 
 // Pin Definitions
 #define LED_PIN 15
@@ -40,6 +42,25 @@ constexpr int interval = 6000;
 
 constexpr float STEP_SIZE = 0.1;
 
+// Controller snapshot configurations (ring of sectors just below the EEPROM sector at the end of flash)
+constexpr uint32_t SNAPSHOT_FLASH_OFFSET = PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE - ControllerSnapshot::REGION_SIZE;
+constexpr unsigned long SNAPSHOT_PERIOD = 30000; // Periodic snapshot interval in miliseconds
+
+// Flash scheduler configurations (page programs fit in the loop slack, erases stall the loop)
+constexpr float FLASH_IDLE_ERROR = 1.0f; // Sector erases only below this tracking error (LUX)
+
+// RAM budget of the metrics and history buffers, the footprint of the original 6000-sample
+// float arrays (the history, tiers, index and recorder sizes are set in their headers)
+constexpr size_t METRICS_RAM_BUDGET = 96 * 1024;
+static_assert(sizeof(dataStorageMetrics) <= METRICS_RAM_BUDGET, "dataStorageMetrics is over its RAM budget");
+
+// Full-rate history kept at steady state, three times the original 6000-sample window
+constexpr uint32_t HISTORY_SAMPLE_TARGET = 3 * 6000;
+static_assert(CompressedHistory::STEADY_SAMPLES >= HISTORY_SAMPLE_TARGET, "CompressedHistory is below its sample target");
+
+// Metrics log configurations (ring of sectors just below the controller snapshots)
+constexpr uint32_t METRICS_LOG_FLASH_OFFSET = SNAPSHOT_FLASH_OFFSET - MetricsLog::REGION_SIZE;
+
 // bootloader configurations
 #define MAX_NODES 3
 
@@ -40,6 +40,9 @@ public:
     // Set the manual mode for the driver
     void setManualMode(bool manualMode);
 
+    // Get the manual mode of the driver
+    bool getManualMode();
+
     // Set Gain and offset d
     void setGainOffset(float _G, float _d);
 
@@ -52,6 +52,10 @@ void Driver::setManualMode(bool manualMode) {
     manualDutyMode = manualMode;
 }
 
+bool Driver::getManualMode() {
+    return manualDutyMode;
+}
+
 void Driver::setGainOffset(float _G, float _d)
 {
     G = _G;
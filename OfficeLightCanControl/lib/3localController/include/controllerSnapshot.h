@@ -0,0 +1,52 @@
+#ifndef CONTROLLER_SNAPSHOT_H
+#define CONTROLLER_SNAPSHOT_H
+
+#include <Arduino.h>
+#include "hardware/flash.h"
+#include <flashRing.h>
+#include <localController.h>
+
+// ControllerSnapshot class definition
+// Keeps a CRC-protected copy of the localController state in a ring of flash sectors
+// so the integrator, reference and bounds survive a reset (warm restart).
+// service only stages a snapshot after the control step (on change or every period), the
+// FlashRing writes it later from the FlashScheduler, outside the 100 Hz step.
+// Arguments:
+// - flashOffset: offset of the first sector from the start of flash (sector aligned)
+// - period: time between periodic snapshots in milliseconds
+// methods :
+// - begin: scan the region for the newest valid snapshot and locate the head
+// - restore: load the newest snapshot into the controller (returns false if none)
+// - service: call after each control step, stages a snapshot when one is due
+// - getRing: flash ring of the snapshots, for the scheduler
+class ControllerSnapshot
+{
+public:
+    // Constructor
+    ControllerSnapshot(uint32_t flashOffset, unsigned long period);
+
+    // Scan the flash region at boot
+    void begin();
+
+    // Restore the newest valid snapshot into the controller
+    bool restore(localController &controller);
+
+    // Periodic and on-change snapshot, call once per control step; returns true if one was staged
+    bool service(localController &controller, unsigned long currentMillis);
+
+    // Get the flash ring holding the snapshots
+    FlashRing &getRing();
+
+    static const uint32_t SECTOR_COUNT = 4;                          // Sectors in the ring
+    static const uint32_t REGION_SIZE = SECTOR_COUNT * FLASH_SECTOR_SIZE; // Bytes of flash used
+
+private:
+    static const uint32_t MAGIC = 0x534C434F; // "OCLS"
+    static_assert(sizeof(controllerState) <= FlashRing::PAYLOAD_SIZE, "snapshot does not fit in a slot");
+
+    FlashRing _ring;
+    unsigned long _period;
+    unsigned long _lastWrite;
+};
+
+#endif
@@ -2,6 +2,30 @@
 #define LOCAL_CONTROLLER
 
 #include <Arduino.h>
+#include <trajectoryGenerator.h>
+#include <stepAnalyser.h>
+
+// Controller state and parameters needed for a warm restart
+struct controllerState
+{
+    float I, r, uPrev;                          // Integral term, reference, last duty cycle
+    float Tk, b, c, Ti, Td, Tt, N;              // PID parameters
+    float lowerBoundOccupied, lowerBoundUnoccupied;
+    uint8_t flags;                              // Mode flags (see STATE_FLAG_*)
+    uint8_t strategy;                           // ControlStrategy (was padding, older snapshots read PID)
+    uint8_t modes;                              // More mode flags (see STATE_MODE_*, was padding)
+    uint8_t smithDelay;                         // Smith predictor dead time in ticks (was padding)
+};
+
+// Control strategies selectable at run time (index into the dispatch table)
+enum ControlStrategy : uint8_t
+{
+    STRATEGY_PID = 0,         // PI with feedforward (explicit MPC when enabled)
+    STRATEGY_INTEGRATOR_ONLY, // Feedforward plus integral term (u = uff + I)
+    STRATEGY_FEEDFORWARD,     // Open loop from the plant model and the observed disturbance
+    STRATEGY_DISTRIBUTED,     // Damped best response to the duty cycles announced by the neighbours
+    STRATEGY_COUNT
+};
 
 class localController
 {
@@ -23,7 +47,121 @@ private:
     bool _occupancy;      // Occupancy control mode flag
     bool _feedback;        // Feedback control mode flag
     bool _antiWindup;      // Anti-windup control mode flag
-    
+    bool _mpc;             // Model predictive control mode flag
+
+    // Explicit MPC for the first-order plant y[k+1] = a*y[k] + (1-a)*(G*u + d)
+    // The law u = K . [r, y, d, u_prev] is precomputed offline in mpcCalc()
+    static const int MPC_MAX_HORIZON = 20;
+    float _plantTau = 0.05f; // Plant model time constant (LDR + filter) in seconds
+    int _mpcHorizon = 10;    // Prediction horizon in samples
+    float _mpcRho = 0.5f;    // Move suppression weight (relative to G^2)
+    float _mpcK[4];          // Gain vector for [r, y, d, u_prev]
+    bool _mpcReady;          // Gain vector is valid (G > 0)
+    float _uPrev;            // Last applied duty cycle (0 to 1)
+
+    // Reference trajectory (S-curve) between the user reference _r and the loop
+    TrajectoryGenerator _trajectory;
+    bool _trajectoryEnabled; // Trajectory generator mode flag (off at boot, "j <i> 1" enables it)
+    float _rt, _rtDot;       // Trajectory reference and its derivative (LUX/s)
+
+    // Neighbour feedforward: light from other desks predicted from their announced duty cycles
+    static const int MAX_NEIGHBOURS = 4;
+    uint8_t _neighbourId[MAX_NEIGHBOURS]; // Desk IDs of the neighbours
+    float _neighbourK[MAX_NEIGHBOURS];    // Coupling gains K_j (LUX at full duty)
+    float _neighbourU[MAX_NEIGHBOURS];    // Last announced duty cycles u_j
+    int _neighbourCount;
+    bool _neighbourFF;   // Neighbour feedforward mode flag (off at boot, "n <i> 1" enables it)
+    float _dn;           // Predicted neighbour illuminance sum_j K_j * u_j
+    float _dnLag;        // Part of _dn already seen by the sensor (plant model lag)
+    float _plantA;       // Plant model pole exp(-h / tau)
+
+    // Disturbance observer for the external illuminance (_external)
+    float _xLed;               // Modelled contribution of our own LED to y (LUX)
+    float _dobBandwidth = 1.0f; // Observer bandwidth in Hz
+    float _dobAlpha;           // Observer low-pass coefficient
+
+    // Cascade: inner proportional loop at the sensor rate around the 100 Hz outer loop
+    bool _cascade;               // Cascade mode flag
+    float _hInner = 0.002f;      // Inner loop sampling period (500 Hz)
+    float _innerLoopGain = 0.5f; // Inner loop gain (dimensionless, duty = gain * e / G)
+    float _uOuter;               // Outer loop output the inner loop corrects (0 to 1)
+    float _innerAw;              // Inner loop saturation excess since the last outer tick
+
+    // Smith predictor: delay line of the LED model output covering the sensing dead time
+    static const int SMITH_DELAY_MASK = 15;        // Ring of 16 samples, max delay 15 ticks
+    float _xLedHistory[SMITH_DELAY_MASK + 1];      // Past LED model outputs
+    int _smithHead;                                // Index of the newest model output
+    int _smithDelay = 2;                           // Model dead time in ticks (RC filter, LDR and average)
+    bool _smith;                                   // Smith predictor mode flag
+    float _yMeasured;                              // Raw measurement (before the Smith correction)
+
+    // Event-triggered control: skip the control step while nothing changes
+    bool _eventTriggered;                    // Event-triggered mode flag
+    float _eventErrorThreshold = 0.3f;       // |r - y| that forces a step (LUX)
+    float _eventInnovationThreshold = 0.2f;  // Change of y since the last step that forces a step (LUX)
+    unsigned long _eventMaxInterval = 200;   // Maximum time between steps in milliseconds
+    float _yLastEvent;                       // Measurement at the last step
+    unsigned long _lastEventMillis;          // Time of the last step
+    uint32_t _eventTicks, _eventSkips;       // Computed and skipped control ticks
+
+    // Strategy registry: compute is called every tick, transfer once on a switch with the
+    // last applied duty cycle so the first output of the new strategy continues from it
+    struct StrategyEntry
+    {
+        float (localController::*compute)();
+        void (localController::*transfer)(float u);
+    };
+    static const StrategyEntry _strategies[STRATEGY_COUNT];
+    ControlStrategy _strategy;
+    float _handover;                          // Feedforward output offset left by the last switch (0 to 1)
+    float _handoverDecay;                     // Per-tick decay of the offset, exp(-h / HANDOVER_TAU)
+    static constexpr float HANDOVER_TAU = 0.5f; // Time constant of the feedforward handover in seconds
+    float _uDistributed;                      // Distributed strategy output (0 to 1)
+    static constexpr float DISTRIBUTED_RELAX = 0.5f; // Damping of the best response (Jacobi iteration)
+
+    // Feedforward in counts from the plant model, trajectory lead, observer and neighbours
+    float feedforward();
+
+    // Strategy compute functions (one tick each, duty cycle 0 to 1)
+    float compute_pid();
+    float compute_integrator();
+    float compute_pi(bool proportional);
+    float compute_feedforward();
+    float compute_distributed();
+
+    // Strategy state transfer from the last applied duty cycle
+    void transfer_pid(float u);
+    void transfer_integrator(float u);
+    void transfer_feedforward(float u);
+    void transfer_distributed(float u);
+
+    // Step response analyser, armed on every reference change
+    StepAnalyser _stepAnalyser;
+
+    bool _stateChanged;      // Set by mode/parameter setters, consumed by the snapshot writer
+
+    static const uint8_t STATE_FLAG_INTEGRATOR_ONLY = 0x01;
+    static const uint8_t STATE_FLAG_BUMPLESS = 0x02;
+    static const uint8_t STATE_FLAG_OCCUPANCY = 0x04;
+    static const uint8_t STATE_FLAG_FEEDBACK = 0x08;
+    static const uint8_t STATE_FLAG_ANTI_WINDUP = 0x10;
+    static const uint8_t STATE_FLAG_MPC = 0x20;
+    static const uint8_t STATE_FLAG_TRAJECTORY = 0x40;
+    static const uint8_t STATE_FLAG_NEIGHBOUR_FF = 0x80;
+    static const uint8_t STATE_MODE_SMITH = 0x01;
+    static const uint8_t STATE_MODE_CASCADE = 0x02;
+    static const uint8_t STATE_MODE_EVENT_TRIGGERED = 0x04;
+    static const uint8_t STATE_MODE_VALID = 0x80; // Set on save, older snapshots keep the defaults
+
+    // Advance the reference trajectory one tick (sets _rt and _rtDot)
+    void updateTrajectory();
+
+    // Advance the sensor-side lag of the neighbour illuminance one tick
+    void updateNeighbourLag();
+
+    // LED model output delayed by the model dead time
+    float delayedLedModel();
+
     float _lowerBoundUnoccupied = 10.0f; // Lower bound for unoccupied state
     float _lowerBoundOccupied = 20.0f; // Lower bound for occupied state
 
@@ -42,14 +180,36 @@ public:
     void update_localController(float K, float b, float c,
                                 float Ti, float Td, float Tt, float N);
 
-    // Compute control output based on reference (r) and measured output (y)
+    // Precompute the explicit MPC gain vector from G, tau, horizon and rho
+    void mpcCalc();
+
+    // Compute control output of the active strategy (reference trajectory and measured output)
     float compute_control();
 
+    // Switch the control strategy, the new one takes over from the last duty cycle (bumpless)
+    void setStrategy(ControlStrategy strategy);
+
+    // Get active control strategy
+    ControlStrategy getStrategy();
+
+    // Explicit MPC control law (dot product + clamp to the 0-1 duty region)
+    float compute_mpc();
+
+    // Cascade inner loop, call at the sensor rate with the latest lux (returns duty cycle)
+    float compute_inner(float y);
+
     // Update internal state (housekeeping) for the PID controller
     void housekeep(float y);
 
+    // Disturbance observer step, estimates the external illuminance (called by housekeep)
     void updateExternal();
 
+    // Set disturbance observer bandwidth in Hz
+    void setObserverBandwidth(float bandwidth);
+
+    // Get disturbance observer bandwidth in Hz
+    float getObserverBandwidth();
+
     // Update box Gain and external Illuminace
     void setGainAndExternal (float Gain, float offset);
 
@@ -71,15 +231,45 @@ public:
     // Set anti-windup control mode
     void setAntiWindup(bool antiWindup);
 
+    // Set MPC mode (false falls back to the PID with feedforward)
+    void setMpc(bool mpc);
+
+    // Set plant model time constant, MPC horizon and move suppression weight
+    void setMpcParameters(float tau, int horizon, float rho);
+
+    // Set trajectory generator mode (false applies reference steps directly)
+    void setTrajectory(bool trajectory);
+
+    // Set trajectory rate (LUX/s), acceleration (LUX/s^2) and jerk (LUX/s^3) limits
+    void setTrajectoryLimits(float vMax, float aMax, float jMax);
+
     // Set lower bound for occupied state
     void setLowerBoundOccupied(float lowerBoundOccupied);
     
     // Set lower bound for unoccupied state
     void setLowerBoundUnoccupied(float lowerBoundUnoccupied);
 
+    // Get the step response analyser (armed by setReference and setOccupancy)
+    StepAnalyser &getStepAnalyser();
+
+    // Copy the controller state and parameters into a snapshot
+    void getState(controllerState &state);
+
+    // Restore the controller state and parameters from a snapshot (warm restart)
+    void setState(const controllerState &state);
+
+    // Returns true once after any mode or parameter change
+    bool consumeStateChanged();
+
+    // Get last tracking error (r - y)
+    float getError();
+
     // Get external illuminance
     float getExternal();
 
+    // Get integral term (PWM counts)
+    float getIntegrator();
+
     // Get reference value
     float getReference();
 
@@ -98,6 +288,72 @@ public:
     // Get anti-windup control mode
     bool getAntiWindup();
 
+    // Event trigger, returns true if the control step must run in this tick
+    bool eventTrigger(float y, unsigned long currentMillis);
+
+    // Set event-triggered mode (false runs the control step every tick)
+    void setEventTriggered(bool eventTriggered);
+
+    // Set error and innovation thresholds (LUX) and maximum interval (ms) of the event trigger
+    void setEventParameters(float errorThreshold, float innovationThreshold, unsigned long maxInterval);
+
+    // Get event-triggered mode
+    bool getEventTriggered();
+
+    // Get number of computed control ticks
+    uint32_t getEventTicks();
+
+    // Get number of skipped control ticks
+    uint32_t getEventSkips();
+
+    // Set Smith predictor mode (feedback on the delay-free model output)
+    void setSmith(bool smith);
+
+    // Set model dead time in control ticks (0 to 15)
+    void setSmithDelay(int delay);
+
+    // Get Smith predictor mode
+    bool getSmith();
+
+    // Get model dead time in control ticks
+    int getSmithDelay();
+
+    // Set cascade mode (inner loop must then be called at the sensor rate while active)
+    void setCascade(bool cascade);
+
+    // Set inner loop period in seconds and inner loop gain
+    void setCascadeParameters(float hInner, float innerLoopGain);
+
+    // Get cascade mode
+    bool getCascade();
+
+    // Get whether the inner loop runs (cascade mode under the PID strategy with MPC off)
+    bool getCascadeActive();
+
+    // Register a neighbour desk and its coupling gain K_j (from calibration)
+    void setNeighbourGain(uint8_t deskId, float K);
+
+    // Apply a duty cycle announced by a neighbour (predicted disturbance K_j * du_j)
+    void setNeighbourDuty(uint8_t deskId, float u);
+
+    // Get the last duty cycle announced by the i-th registered neighbour (0 if none)
+    float getNeighbourDuty(int i);
+
+    // Set neighbour feedforward mode
+    void setNeighbourFeedforward(bool neighbourFF);
+
+    // Get MPC mode
+    bool getMpc();
+
+    // Get neighbour feedforward mode
+    bool getNeighbourFeedforward();
+
+    // Get trajectory generator mode
+    bool getTrajectory();
+
+    // Get the reference currently tracked by the loop (trajectory position)
+    float getTrajectoryReference();
+
     // Get lower bound for occupied state
     float getLowerBoundOccupied();
 
@@ -0,0 +1,54 @@
+#ifndef STEP_ANALYSER_H
+#define STEP_ANALYSER_H
+
+#include <Arduino.h>
+
+// StepAnalyser class definition
+// Measures the step response of the loop on the device, one sample at a time and in constant memory.
+// Armed on every reference change, it tracks rise time (10% to 90%), overshoot, settling time
+// (last entry into the settling band) and steady-state error (mean error once settled).
+// Arguments:
+// - h: sampling period in seconds
+// methods :
+// - arm: start a new analysis from the current output towards the new reference
+// - update: feed one measured sample
+// - consumeReport: returns true once when a finished analysis is ready to be reported
+class StepAnalyser
+{
+public:
+    // Constructor
+    StepAnalyser(float h = 0.01f);
+
+    // Start analysing a step from y0 to reference r
+    void arm(float y0, float r);
+
+    // Feed one measured sample
+    void update(float y);
+
+    // True once after the response settled (or timed out)
+    bool consumeReport();
+
+    float getStep();            // Step amplitude (LUX)
+    float getRiseTime();        // 10% to 90% rise time in seconds (-1 if not reached)
+    float getOvershoot();       // Overshoot in percent of the step
+    float getSettlingTime();    // Settling time in seconds (-1 if it did not settle)
+    float getSteadyStateError();// Mean r - y once settled (LUX)
+
+private:
+    static constexpr float MIN_STEP = 0.5f;      // Smaller reference changes are ignored (LUX)
+    static constexpr float BAND = 0.02f;         // Settling band relative to the step
+    static constexpr float MIN_BAND = 0.2f;      // Minimum settling band (LUX)
+    static constexpr float HOLD_TIME = 0.5f;     // Time inside the band to declare settled (s)
+    static constexpr float TIMEOUT = 10.0f;      // Give up after this time (s)
+
+    float _h;
+    bool _armed, _reportReady;
+    float _y0, _r, _step, _band;
+    float _t, _t10, _t90, _tSettle;
+    float _peak;               // Maximum normalised progress (y - y0) / step
+    float _errorSum;           // Sum of r - y since the last entry into the band
+    uint16_t _errorCount;
+    float _sse;
+};
+
+#endif
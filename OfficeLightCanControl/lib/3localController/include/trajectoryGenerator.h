@@ -0,0 +1,56 @@
+#ifndef TRAJECTORY_GENERATOR_H
+#define TRAJECTORY_GENERATOR_H
+
+#include <Arduino.h>
+
+// TrajectoryGenerator class definition
+// Turns reference steps into rate, acceleration and jerk limited profiles (S-curves).
+// The profile is advanced incrementally once per control tick: every tick takes the largest
+// acceleration within the jerk limit from which the closed-form braking distance (from the
+// full velocity and acceleration state) still fits before the target, so it brakes to rest on
+// the target without overshoot and without violating the limits, also when the target moves.
+// Arguments:
+// - vMax: maximum rate of change of the reference (LUX/s)
+// - aMax: maximum acceleration of the reference (LUX/s^2)
+// - jMax: maximum jerk of the reference (LUX/s^3)
+// methods :
+// - reset: jump to a position with zero velocity and acceleration
+// - update: advance one tick of h seconds towards the target, returns the new position
+// - getVelocity: derivative of the reference, used as feedforward
+class TrajectoryGenerator
+{
+public:
+    // Constructor
+    TrajectoryGenerator(float vMax = 50.0f, float aMax = 200.0f, float jMax = 2000.0f);
+
+    // Set the rate, acceleration and jerk limits
+    void setLimits(float vMax, float aMax, float jMax);
+
+    // Jump to position p at rest
+    void reset(float p);
+
+    // Advance one tick towards target, returns the profile position
+    float update(float target, float h);
+
+    // Get the profile position
+    float getPosition();
+
+    // Get the profile velocity (LUX/s)
+    float getVelocity();
+
+private:
+    static const int BISECTION_STEPS = 12;             // Resolution of the braking acceleration
+    static constexpr float LANDING_TOLERANCE = 0.003f; // Landing on the target jumps at most this * jMax * h in acceleration
+
+    float _vMax, _aMax, _jMax; // Limits
+    float _p, _v, _a;          // Position, velocity and acceleration of the profile
+
+    // True if acceleration a for the next tick respects the velocity limit and still lets the
+    // profile stop within distance d (direction of the target positive)
+    bool feasible(float d, float v, float a, float h);
+
+    // Distance covered braking to rest from velocity v and acceleration a
+    float stopDistance(float v, float a);
+};
+
+#endif
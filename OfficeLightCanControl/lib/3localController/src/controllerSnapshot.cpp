@@ -0,0 +1,49 @@
+#include <controllerSnapshot.h>
+
+ControllerSnapshot::ControllerSnapshot(uint32_t flashOffset, unsigned long period)
+    : _ring(flashOffset, SECTOR_COUNT, MAGIC), _period(period), _lastWrite(0)
+{
+}
+
+void ControllerSnapshot::begin()
+{
+    _ring.begin();
+    Serial.printf("Snapshot: newest slot %ld, head slot %lu\n", (long)_ring.getNewestSlot(),
+                  (unsigned long)_ring.getHeadSlot());
+}
+
+bool ControllerSnapshot::restore(localController &controller)
+{
+    const uint8_t *payload = _ring.getNewest();
+    if (payload == nullptr)
+    {
+        return false;
+    }
+
+    controllerState state;
+    memcpy(&state, payload, sizeof(state));
+    controller.setState(state);
+    controller.consumeStateChanged(); // Restored state is already on flash
+    return true;
+}
+
+bool ControllerSnapshot::service(localController &controller, unsigned long currentMillis)
+{
+    if (!controller.consumeStateChanged() && currentMillis - _lastWrite < _period)
+    {
+        return false;
+    }
+
+    // Staged in RAM, a newer snapshot replaces one the scheduler has not written yet
+    controllerState state;
+    memset(&state, 0, sizeof(state)); // Deterministic padding for the CRC
+    controller.getState(state);
+    _ring.append(&state, sizeof(state));
+    _lastWrite = currentMillis;
+    return true;
+}
+
+FlashRing &ControllerSnapshot::getRing()
+{
+    return _ring;
+}
@@ -14,7 +14,17 @@ localController::localController(
       _r{0.0}, _y{0.0},
       _u{0.0}, _v{0.0},
       _error{0.0}, _dutyError{0.0},
-      _bi{0.0}, _ad{0.0}, _bd{0.0}, _ao{0.0}
+      _bi{0.0}, _ad{0.0}, _bd{0.0}, _ao{0.0},
+      _mpc{false}, _mpcK{0.0, 0.0, 0.0, 0.0}, _mpcReady{false}, _uPrev{0.0},
+      _trajectoryEnabled{false}, _rt{0.0}, _rtDot{0.0},
+      _neighbourCount{0}, _neighbourFF{false}, _dn{0.0}, _dnLag{0.0}, _plantA{0.0},
+      _xLed{0.0}, _dobAlpha{0.0},
+      _cascade{false}, _uOuter{0.0}, _innerAw{0.0},
+      _smithHead{0}, _smith{false}, _yMeasured{0.0},
+      _eventTriggered{false}, _yLastEvent{0.0}, _lastEventMillis{0}, _eventTicks{0}, _eventSkips{0},
+      _strategy{STRATEGY_PID}, _handover{0.0}, _handoverDecay{0.0}, _uDistributed{0.0},
+      _stepAnalyser{h},
+      _stateChanged{false}
 {
     constantCalc(); // Calculate the constants in the local controller
     if (_occupancy)
@@ -25,6 +35,13 @@ localController::localController(
     {
         _r = _lowerBoundUnoccupied; // Set reference to lower bound if below threshold
     }
+    _trajectory.reset(_r);
+    _rt = _r;
+
+    for (int i = 0; i <= SMITH_DELAY_MASK; i++)
+    {
+        _xLedHistory[i] = 0.0f;
+    }
 }
 
 // Destructor (empty as no dynamic memory is managed)
@@ -32,14 +49,58 @@ localController::~localController()
 {
 }
 
-// Compute the control output (u) using PID formula
+const localController::StrategyEntry localController::_strategies[STRATEGY_COUNT] = {
+    {&localController::compute_pid, &localController::transfer_pid},                 // STRATEGY_PID
+    {&localController::compute_integrator, &localController::transfer_integrator},   // STRATEGY_INTEGRATOR_ONLY
+    {&localController::compute_feedforward, &localController::transfer_feedforward}, // STRATEGY_FEEDFORWARD
+    {&localController::compute_distributed, &localController::transfer_distributed}, // STRATEGY_DISTRIBUTED
+};
+
+// Compute the control output (u) of the active strategy
 float localController::compute_control()
 {
-    float P = _Tk * (_b * _r - _y); // Proportional Term
+    updateTrajectory();
+    updateNeighbourLag();
+
+    return (this->*_strategies[_strategy].compute)();
+}
+
+float localController::feedforward()
+{
+    // Feedforward from the plant model, the trajectory lead and the observed external illuminance
+    float uff = (4095.0f / _gain) * (_rt + _plantTau * _rtDot - _external);
+    if (_neighbourFF)
+    {
+        uff -= (4095.0f / _gain) * (_dn - _dnLag); // Neighbour light not yet seen by the sensor
+    }
+    return uff;
+}
+
+float localController::compute_pid()
+{
+    if (_mpc && _mpcReady)
+    {
+        _uOuter = compute_mpc();
+        _innerAw = 0.0f;
+        transfer_pid(_uOuter); // Track the MPC output so switching MPC off is bumpless
+        return _uOuter;
+    }
+    return compute_pi(true);
+}
+
+float localController::compute_integrator()
+{
+    return compute_pi(false);
+}
+
+// Compute the control output (u) using PID formula
+float localController::compute_pi(bool proportional)
+{
+    // In cascade mode the proportional action runs in the inner loop at the sensor rate
+    float P = (_cascade || !proportional) ? 0.0f : _Tk * (_b * _rt - _y); // Proportional Term
 
     float ut = 0;
-    float d = _y - (_gain * (_u * 4095.0f));
-    float uff = (4095.0f / _gain) * _r - d;
+    float uff = feedforward();
     if (_feedback){
        ut = P + _I;
     }
@@ -57,22 +118,165 @@ float localController::compute_control()
 
     // Anti-Windup with Back Calculation
     float K_aw = 1 / _Tt; // Anti-Windup Gain 
-    _I += (_Tk * _h / _Ti) * (_r - _y) + K_aw * (u_sat - ut) * _h;
+    // In cascade mode the inner loop saturation since the last outer tick is added as well
+    _I += (_Tk * _h / _Ti) * (_rt - _y) + K_aw * ((u_sat - ut) * _h + _innerAw);
+    _innerAw = 0.0f;
 
 
     //housekeep(r, y); // Update integral and previous measurement
 
-    return u_sat/4095;
+    _uPrev = u_sat / 4095; // Keep the MPC move penalty continuous on mode switch
+    _uOuter = _uPrev;
+    return _uPrev;
+}
+
+float localController::compute_feedforward()
+{
+    // Open loop, the offset left by a strategy switch fades out with HANDOVER_TAU
+    float u = constrain(feedforward() / 4095.0f + _handover, 0.0f, 1.0f);
+    _handover *= _handoverDecay;
+
+    _uPrev = u;
+    _uOuter = u;
+    _innerAw = 0.0f;
+    return u;
+}
+
+float localController::compute_distributed()
+{
+    // Best response to the announced neighbour duty cycles (as in DistributedLuminaire):
+    // u = (r - d - sum_j K_j u_j) / G, with d the observed background without the neighbour
+    // light already seen by the sensor. Damped so simultaneous updates of all desks converge
+    if (_gain > 0)
+    {
+        float d = _external - _dnLag;
+        float uBest = (_rt + _plantTau * _rtDot - d - _dn) / _gain;
+        _uDistributed += DISTRIBUTED_RELAX * (constrain(uBest, 0.0f, 1.0f) - _uDistributed);
+    }
+
+    _uPrev = _uDistributed;
+    _uOuter = _uDistributed;
+    _innerAw = 0.0f;
+    return _uDistributed;
+}
+
+void localController::transfer_pid(float u)
+{
+    // Integral term absorbs the difference so P + I + uff equals the last output
+    float P = _cascade ? 0.0f : _Tk * (_b * _rt - _y);
+    _I = u * 4095.0f - P - feedforward();
+}
+
+void localController::transfer_integrator(float u)
+{
+    _I = u * 4095.0f - feedforward();
+}
+
+void localController::transfer_feedforward(float u)
+{
+    _handover = u - feedforward() / 4095.0f;
+}
+
+void localController::transfer_distributed(float u)
+{
+    _uDistributed = u;
+}
+
+void localController::setStrategy(ControlStrategy strategy)
+{
+    if (strategy >= STRATEGY_COUNT || strategy == _strategy)
+    {
+        return;
+    }
+    if (_gain > 0)
+    {
+        (this->*_strategies[strategy].transfer)(_uPrev);
+    }
+    _strategy = strategy;
+    _stateChanged = true;
+}
+
+ControlStrategy localController::getStrategy()
+{
+    return _strategy;
+}
+
+// Inner loop of the cascade: proportional correction around the outer loop output,
+// run at the sensor rate with the freshest lux sample
+float localController::compute_inner(float y)
+{
+    if (_gain <= 0)
+    {
+        return _uOuter; // No plant gain yet, nothing to scale the correction with
+    }
+
+    float ut = _uOuter + _innerLoopGain * (_rt - y) / _gain;
+    float u_sat = constrain(ut, 0.0f, 1.0f);
+
+    // Saturation excess in counts * s, consumed by the outer anti-windup
+    _innerAw += (u_sat - ut) * 4095.0f * _hInner;
+
+    _uPrev = u_sat;
+    return u_sat;
+}
+
+// Explicit MPC: the QP over a constant move is scalar, so the constrained
+// optimum is the unconstrained law clamped to [0, 1] (three regions)
+float localController::compute_mpc()
+{
+    float d = _neighbourFF ? _external + _dn - _dnLag : _external; // Observed disturbance plus unseen neighbour light
+    float u = _mpcK[0] * (_rt + _plantTau * _rtDot) + _mpcK[1] * _y + _mpcK[2] * d + _mpcK[3] * _uPrev;
+
+    if (u < 0.0f)
+    {
+        u = 0.0f;
+    }
+    if (u > 1.0f)
+    {
+        u = 1.0f;
+    }
+
+    _uPrev = u;
+    return u;
+}
+
+void localController::updateNeighbourLag()
+{
+    // The sensor sees neighbour light through the same first-order lag as our own LED
+    _dnLag += (1.0f - _plantA) * (_dn - _dnLag);
+}
+
+void localController::updateTrajectory()
+{
+    if (_trajectoryEnabled)
+    {
+        _rt = _trajectory.update(_r, _h);
+        _rtDot = _trajectory.getVelocity();
+    }
+    else
+    {
+        _trajectory.reset(_r); // Keep the generator in sync so enabling it is bumpless
+        _rt = _r;
+        _rtDot = 0.0f;
+    }
 }
 
 // Inline implementation of housekeep to update integral term and store previous output
 void localController::housekeep(float y)
 {
+    _yMeasured = y;
+    if (_smith)
+    {
+        y += _xLed - delayedLedModel(); // Smith predictor: feed back the delay-free model output
+    }
+
     _y = y;                                // Store current output
-    _error = _r - y;                       // Error: difference between reference and measured output
+    _error = _rt - y;                      // Error: difference between reference and measured output
     _dutyError = _u - _v;                  // Compute duty error (difference between desired and actual output)
     _I += _bi * _error + _ao * _dutyError; // Update integral term using proportional gain, sampling period, and integral time
     _yOld = y;                             // Store current output as previous output for next iteration
+
+    updateExternal(); // Disturbance observer step
 }
 
 void localController::update_localController(float Tk, float b, float c,
@@ -96,6 +300,7 @@ void localController::update_localController(float Tk, float b, float c,
     _N_ = N;
 
     constantCalc(); // Calculate the constants in the local controller  
+    _stateChanged = true;
 }
 
 void localController::constantCalc()
@@ -136,37 +341,96 @@ void localController::constantCalc()
     _bi = _Tk * _h / _Ti; // Integral gain coefficient (b_i)
 
     _ao = _h / _Tt; // Anti-windup gain coefficient (a_o)
+
+    _plantA = (_plantTau > 0) ? exp(-_h / _plantTau) : 0.0f; // Plant model pole
+    _dobAlpha = 1.0f - exp(-2.0f * PI * _dobBandwidth * _h); // Observer low-pass coefficient
+    _handoverDecay = exp(-_h / HANDOVER_TAU);                  // Feedforward handover decay
+
+    mpcCalc(); // Gain vector depends on G and h
+}
+
+void localController::mpcCalc()
+{
+    // Cost J = sum_i (y_i - r)^2 + rho*G^2*(u - u_prev)^2 with u held over the horizon
+    // and y_i = a^i*y + s_i*(G*u + d), s_i = 1 - a^i
+    _mpcReady = false;
+    if (_gain <= 0 || _plantTau <= 0 || _mpcHorizon <= 0)
+    {
+        return;
+    }
+
+    float a = exp(-_h / _plantTau);
+    float ai = 1.0f;
+    float sumS = 0.0f, sumS2 = 0.0f, sumSA = 0.0f;
+    for (int i = 1; i <= _mpcHorizon; i++)
+    {
+        ai *= a;
+        float si = 1.0f - ai;
+        sumS += si;
+        sumS2 += si * si;
+        sumSA += si * ai;
+    }
+
+    float lambda = _mpcRho * _gain * _gain;
+    float den = _gain * _gain * sumS2 + lambda;
+    if (den <= 0)
+    {
+        return;
+    }
+
+    _mpcK[0] = _gain * sumS / den;  // r
+    _mpcK[1] = -_gain * sumSA / den; // y
+    _mpcK[2] = -_gain * sumS2 / den; // d
+    _mpcK[3] = lambda / den;         // u_prev
+    _mpcReady = true;
 }
 
 void localController::updateExternal()
 {
-    // Update the external illuminance
-    _external = _y - (_gain * _u / 4096); // Calculate the external illuminance based on the measured output and control signal
-    // Serial.printf("External: %.2f, Gain: %.2f, Duty Cycle: %.2f, LDR: %.2f\n", _external, _gain, _u, _y); // Debug output
+    // Disturbance observer: the measurement minus the modelled contribution of our own LED
+    // (first-order lag), low-pass filtered with the observer bandwidth
+    float dRaw = _yMeasured - delayedLedModel();
+    _external += _dobAlpha * (dRaw - _external);
+
+    // Advance the LED model with the duty cycle applied in this tick
+    _xLed += (1.0f - _plantA) * (_gain * _uPrev - _xLed);
 
+    // Delay line of the model output for the sensing dead time
+    _smithHead = (_smithHead + 1) & SMITH_DELAY_MASK;
+    _xLedHistory[_smithHead] = _xLed;
+}
+
+float localController::delayedLedModel()
+{
+    return _xLedHistory[(_smithHead - _smithDelay) & SMITH_DELAY_MASK];
 }
 
 void localController::setGainAndExternal(float gain, float offset)
 {
     _gain = gain;         // Update the gain value
     _offset = offset; // Update the reference value
+    _external = offset; // Start the observer from the calibrated background
 
     constantCalc(); // Calculate the constants in the local controller
 }
 
 void localController::setReference(float r)
 {
+    _stepAnalyser.arm(_yMeasured, r);
     _r = r;
+    _stateChanged = true;
 }
 
 void localController::setIntegratorOnly(bool integratorOnly)
 {
     _integratorOnly = integratorOnly;
+    _stateChanged = true;
 }
 
 void localController::setBumpLess(bool bumpLess)
 {
     _bumpLess = bumpLess;
+    _stateChanged = true;
 }
 
 void localController::setOccupancy(bool occupancy)
@@ -180,34 +444,332 @@ void localController::setOccupancy(bool occupancy)
     {
         _r = _lowerBoundUnoccupied; // Set reference to lower bound if below threshold
     }
+    _stepAnalyser.arm(_yMeasured, _r);
+    _stateChanged = true;
 }
 
 void localController::setFeedback(bool feedback)
 {
     _feedback = feedback;
+    _stateChanged = true;
 }
 
 void localController::setAntiWindup(bool antiWindup)
 {
     _antiWindup = antiWindup;
+    _stateChanged = true;
+}
+
+void localController::setMpc(bool mpc)
+{
+    _mpc = mpc;
+    _stateChanged = true;
+}
+
+void localController::setMpcParameters(float tau, int horizon, float rho)
+{
+    _plantTau = tau;
+    _mpcHorizon = constrain(horizon, 1, MPC_MAX_HORIZON);
+    _mpcRho = rho;
+
+    _plantA = (_plantTau > 0) ? exp(-_h / _plantTau) : 0.0f; // Plant model pole
+    mpcCalc(); // Recompute the gain vector offline
+}
+
+void localController::setObserverBandwidth(float bandwidth)
+{
+    if (bandwidth <= 0)
+    {
+        Serial.println("Observer bandwidth must be positive.");
+        return;
+    }
+    _dobBandwidth = bandwidth;
+    _dobAlpha = 1.0f - exp(-2.0f * PI * _dobBandwidth * _h);
+}
+
+float localController::getObserverBandwidth()
+{
+    return _dobBandwidth;
+}
+
+bool localController::eventTrigger(float y, unsigned long currentMillis)
+{
+    if (!_eventTriggered)
+    {
+        _eventTicks++;
+        return true;
+    }
+
+    bool trigger = fabsf(_r - _rt) > 0.0f ||                                    // Trajectory still moving
+                   fabsf(_rt - y) > _eventErrorThreshold ||                     // Tracking error
+                   fabsf(y - _yLastEvent) > _eventInnovationThreshold ||        // Measurement moved
+                   fabsf(_dn - _dnLag) > _eventInnovationThreshold ||           // Neighbour announced a change
+                   currentMillis - _lastEventMillis >= _eventMaxInterval;       // Keep-alive
+
+    if (!trigger)
+    {
+        _eventSkips++;
+        return false;
+    }
+
+    _yLastEvent = y;
+    _lastEventMillis = currentMillis;
+    _eventTicks++;
+    return true;
+}
+
+void localController::setEventTriggered(bool eventTriggered)
+{
+    _eventTriggered = eventTriggered;
+    _stateChanged = true;
+}
+
+void localController::setEventParameters(float errorThreshold, float innovationThreshold, unsigned long maxInterval)
+{
+    _eventErrorThreshold = errorThreshold;
+    _eventInnovationThreshold = innovationThreshold;
+    _eventMaxInterval = maxInterval;
+}
+
+bool localController::getEventTriggered()
+{
+    return _eventTriggered;
+}
+
+uint32_t localController::getEventTicks()
+{
+    return _eventTicks;
+}
+
+uint32_t localController::getEventSkips()
+{
+    return _eventSkips;
+}
+
+void localController::setSmith(bool smith)
+{
+    _smith = smith;
+    _stateChanged = true;
+}
+
+void localController::setSmithDelay(int delay)
+{
+    _smithDelay = constrain(delay, 0, SMITH_DELAY_MASK);
+    _stateChanged = true;
+}
+
+bool localController::getSmith()
+{
+    return _smith;
+}
+
+int localController::getSmithDelay()
+{
+    return _smithDelay;
+}
+
+void localController::setCascade(bool cascade)
+{
+    _cascade = cascade;
+    _innerAw = 0.0f;
+    _stateChanged = true;
+}
+
+void localController::setCascadeParameters(float hInner, float innerLoopGain)
+{
+    _hInner = hInner;
+    _innerLoopGain = innerLoopGain;
+}
+
+bool localController::getCascade()
+{
+    return _cascade;
+}
+
+bool localController::getCascadeActive()
+{
+    // The inner loop stands in for the proportional term of the PI law; the output of MPC
+    // and of the other strategies is not an operating point it can correct around
+    return _cascade && _strategy == STRATEGY_PID && !(_mpc && _mpcReady);
+}
+
+void localController::setNeighbourGain(uint8_t deskId, float K)
+{
+    for (int i = 0; i < _neighbourCount; i++)
+    {
+        if (_neighbourId[i] == deskId)
+        {
+            _dn += (K - _neighbourK[i]) * _neighbourU[i];
+            _dnLag = _dn;
+            _neighbourK[i] = K;
+            return;
+        }
+    }
+    if (_neighbourCount >= MAX_NEIGHBOURS)
+    {
+        Serial.printf("Neighbour table full, desk %d ignored\n", deskId);
+        return;
+    }
+    _neighbourId[_neighbourCount] = deskId;
+    _neighbourK[_neighbourCount] = K;
+    _neighbourU[_neighbourCount] = 0.0f;
+    _neighbourCount++;
+}
+
+void localController::setNeighbourDuty(uint8_t deskId, float u)
+{
+    for (int i = 0; i < _neighbourCount; i++)
+    {
+        if (_neighbourId[i] == deskId)
+        {
+            _dn += _neighbourK[i] * (u - _neighbourU[i]); // Predicted disturbance K_j * du_j
+            _neighbourU[i] = u;
+            return;
+        }
+    }
+}
+
+float localController::getNeighbourDuty(int i)
+{
+    return i < _neighbourCount ? _neighbourU[i] : 0.0f;
+}
+
+void localController::setNeighbourFeedforward(bool neighbourFF)
+{
+    _neighbourFF = neighbourFF;
+    _stateChanged = true;
+}
+
+void localController::setTrajectory(bool trajectory)
+{
+    _trajectoryEnabled = trajectory;
+    _stateChanged = true;
+}
+
+void localController::setTrajectoryLimits(float vMax, float aMax, float jMax)
+{
+    _trajectory.setLimits(vMax, aMax, jMax);
 }
 
 // Set lower bound for occupied state
 void localController::setLowerBoundOccupied(float lowerBoundOccupied)
 {
     _lowerBoundOccupied = lowerBoundOccupied; // Update the lower bound for occupied state
+    _stateChanged = true;
 }
 
 // Set lower bound for unoccupied state
 void localController::setLowerBoundUnoccupied(float lowerBoundUnoccupied)
 {
     _lowerBoundUnoccupied = lowerBoundUnoccupied; // Update the lower bound for unoccupied state
+    _stateChanged = true;
+}
+
+StepAnalyser &localController::getStepAnalyser()
+{
+    return _stepAnalyser;
+}
+
+void localController::getState(controllerState &state)
+{
+    state.I = _I;
+    state.r = _r;
+    state.uPrev = _uPrev;
+    state.Tk = _Tk;
+    state.b = _b;
+    state.c = _c;
+    state.Ti = _Ti;
+    state.Td = _Td;
+    state.Tt = _Tt;
+    state.N = _N_;
+    state.lowerBoundOccupied = _lowerBoundOccupied;
+    state.lowerBoundUnoccupied = _lowerBoundUnoccupied;
+    state.flags = (_integratorOnly ? STATE_FLAG_INTEGRATOR_ONLY : 0) |
+                  (_bumpLess ? STATE_FLAG_BUMPLESS : 0) |
+                  (_occupancy ? STATE_FLAG_OCCUPANCY : 0) |
+                  (_feedback ? STATE_FLAG_FEEDBACK : 0) |
+                  (_antiWindup ? STATE_FLAG_ANTI_WINDUP : 0) |
+                  (_mpc ? STATE_FLAG_MPC : 0) |
+                  (_trajectoryEnabled ? STATE_FLAG_TRAJECTORY : 0) |
+                  (_neighbourFF ? STATE_FLAG_NEIGHBOUR_FF : 0);
+    state.strategy = _strategy;
+    state.modes = STATE_MODE_VALID |
+                  (_smith ? STATE_MODE_SMITH : 0) |
+                  (_cascade ? STATE_MODE_CASCADE : 0) |
+                  (_eventTriggered ? STATE_MODE_EVENT_TRIGGERED : 0);
+    state.smithDelay = _smithDelay;
+}
+
+void localController::setState(const controllerState &state)
+{
+    _Tk = state.Tk;
+    _b = state.b;
+    _c = state.c;
+    _Ti = state.Ti;
+    _Td = state.Td;
+    _Tt = state.Tt;
+    _N_ = state.N;
+    _lowerBoundOccupied = state.lowerBoundOccupied;
+    _lowerBoundUnoccupied = state.lowerBoundUnoccupied;
+
+    _integratorOnly = state.flags & STATE_FLAG_INTEGRATOR_ONLY;
+    _bumpLess = state.flags & STATE_FLAG_BUMPLESS;
+    _occupancy = state.flags & STATE_FLAG_OCCUPANCY;
+    _feedback = state.flags & STATE_FLAG_FEEDBACK;
+    _antiWindup = state.flags & STATE_FLAG_ANTI_WINDUP;
+    _mpc = state.flags & STATE_FLAG_MPC;
+    _trajectoryEnabled = state.flags & STATE_FLAG_TRAJECTORY;
+    _neighbourFF = state.flags & STATE_FLAG_NEIGHBOUR_FF;
+    if (state.modes & STATE_MODE_VALID)
+    {
+        _smith = state.modes & STATE_MODE_SMITH;
+        _cascade = state.modes & STATE_MODE_CASCADE;
+        _eventTriggered = state.modes & STATE_MODE_EVENT_TRIGGERED;
+        _smithDelay = constrain(state.smithDelay, 0, SMITH_DELAY_MASK);
+    }
+
+    constantCalc(); // Recompute the constants (also resets _r to the lower bound)
+
+    // Dynamic state is restored after constantCalc so it is not overwritten
+    _r = state.r;
+    _trajectory.reset(_r); // Resume on the setpoint, no ramp after a warm restart
+    _rt = _r;
+    _I = state.I;
+    _uPrev = state.uPrev;
+    _xLed = _gain * _uPrev; // Assume the LED model starts at steady state
+    for (int i = 0; i <= SMITH_DELAY_MASK; i++)
+    {
+        _xLedHistory[i] = _xLed;
+    }
+
+    // The integral term is in the snapshot; the other strategies continue from the last duty cycle
+    _strategy = state.strategy < STRATEGY_COUNT ? (ControlStrategy)state.strategy : STRATEGY_PID;
+    if (_gain > 0 && _strategy != STRATEGY_PID && _strategy != STRATEGY_INTEGRATOR_ONLY)
+    {
+        (this->*_strategies[_strategy].transfer)(_uPrev);
+    }
+}
+
+bool localController::consumeStateChanged()
+{
+    bool changed = _stateChanged;
+    _stateChanged = false;
+    return changed;
+}
+
+float localController::getError()
+{
+    return _error;
 }
 
 float localController::getExternal()
 {
-    updateExternal(); // Update the external illuminance value
-    return _external; // Return the gain value
+    return _external; // Observer estimate, updated every tick in housekeep
+}
+
+float localController::getIntegrator()
+{
+    return _I;
 }
 
 float localController::getReference()
@@ -240,6 +802,26 @@ bool localController::getAntiWindup()
     return _antiWindup;
 }
 
+bool localController::getMpc()
+{
+    return _mpc;
+}
+
+bool localController::getNeighbourFeedforward()
+{
+    return _neighbourFF;
+}
+
+bool localController::getTrajectory()
+{
+    return _trajectoryEnabled;
+}
+
+float localController::getTrajectoryReference()
+{
+    return _rt;
+}
+
 float localController::getLowerBoundOccupied()
 {
     return _lowerBoundOccupied;
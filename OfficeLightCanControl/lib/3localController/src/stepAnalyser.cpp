@@ -0,0 +1,128 @@
+#include <stepAnalyser.h>
+
+StepAnalyser::StepAnalyser(float h)
+    : _h(h), _armed(false), _reportReady(false),
+      _y0(0.0f), _r(0.0f), _step(0.0f), _band(0.0f),
+      _t(0.0f), _t10(-1.0f), _t90(-1.0f), _tSettle(-1.0f),
+      _peak(0.0f), _errorSum(0.0f), _errorCount(0), _sse(0.0f)
+{
+}
+
+void StepAnalyser::arm(float y0, float r)
+{
+    if (fabsf(r - y0) < MIN_STEP)
+    {
+        return;
+    }
+
+    _armed = true;
+    _reportReady = false;
+    _y0 = y0;
+    _r = r;
+    _step = r - y0;
+    _band = fabsf(_step) * BAND;
+    if (_band < MIN_BAND)
+    {
+        _band = MIN_BAND;
+    }
+
+    _t = 0.0f;
+    _t10 = -1.0f;
+    _t90 = -1.0f;
+    _tSettle = -1.0f;
+    _peak = 0.0f;
+    _errorSum = 0.0f;
+    _errorCount = 0;
+    _sse = 0.0f;
+}
+
+void StepAnalyser::update(float y)
+{
+    if (!_armed)
+    {
+        return;
+    }
+
+    _t += _h;
+    float progress = (y - _y0) / _step;
+
+    // Rise time marks
+    if (_t10 < 0 && progress >= 0.1f)
+    {
+        _t10 = _t;
+    }
+    if (_t90 < 0 && progress >= 0.9f)
+    {
+        _t90 = _t;
+    }
+
+    // Overshoot
+    if (progress > _peak)
+    {
+        _peak = progress;
+    }
+
+    // Settling: restart the window each time the output leaves the band
+    float error = _r - y;
+    if (fabsf(error) > _band)
+    {
+        _tSettle = -1.0f;
+        _errorSum = 0.0f;
+        _errorCount = 0;
+    }
+    else
+    {
+        if (_tSettle < 0)
+        {
+            _tSettle = _t;
+        }
+        _errorSum += error;
+        _errorCount++;
+    }
+
+    if (_tSettle >= 0 && _t - _tSettle >= HOLD_TIME)
+    {
+        _sse = _errorSum / _errorCount;
+        _armed = false;
+        _reportReady = true;
+    }
+    else if (_t >= TIMEOUT)
+    {
+        _tSettle = -1.0f;
+        _sse = _errorCount ? _errorSum / _errorCount : error;
+        _armed = false;
+        _reportReady = true;
+    }
+}
+
+bool StepAnalyser::consumeReport()
+{
+    bool ready = _reportReady;
+    _reportReady = false;
+    return ready;
+}
+
+float StepAnalyser::getStep()
+{
+    return _step;
+}
+
+float StepAnalyser::getRiseTime()
+{
+    return (_t10 >= 0 && _t90 >= 0) ? _t90 - _t10 : -1.0f;
+}
+
+float StepAnalyser::getOvershoot()
+{
+    return (_peak > 1.0f) ? (_peak - 1.0f) * 100.0f : 0.0f;
+}
+
+float StepAnalyser::getSettlingTime()
+{
+    return _tSettle;
+}
+
+float StepAnalyser::getSteadyStateError()
+{
+    return _sse;
+}
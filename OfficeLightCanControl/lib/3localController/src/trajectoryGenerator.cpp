@@ -0,0 +1,115 @@
+#include <trajectoryGenerator.h>
+
+#include <float.h>
+
+TrajectoryGenerator::TrajectoryGenerator(float vMax, float aMax, float jMax)
+    : _vMax(vMax), _aMax(aMax), _jMax(jMax), _p(0.0f), _v(0.0f), _a(0.0f)
+{
+}
+
+void TrajectoryGenerator::setLimits(float vMax, float aMax, float jMax)
+{
+    _vMax = vMax;
+    _aMax = aMax;
+    _jMax = jMax;
+}
+
+void TrajectoryGenerator::reset(float p)
+{
+    _p = p;
+    _v = 0.0f;
+    _a = 0.0f;
+}
+
+float TrajectoryGenerator::update(float target, float h)
+{
+    float e = target - _p;
+    // Acceleration step small next to the jerk limit, but never below the float resolution of
+    // the position (a few ulp), which the profile cannot resolve any further
+    float landing = fmaxf(LANDING_TOLERANCE * _jMax * h, 4.0f * FLT_EPSILON * fabsf(target) / (h * h));
+    if (fabsf(e) <= landing * h * h && fabsf(_v) <= landing * h && fabsf(_a) <= landing)
+    {
+        reset(target); // Residual below what one jerk-limited tick moves, land on the target
+        return _p;
+    }
+
+    // Work in the direction of the target (or of the motion when already on it)
+    float s = (e > 0.0f || (e == 0.0f && _v > 0.0f)) ? 1.0f : -1.0f;
+    float d = s * e, v = s * _v, a = s * _a;
+
+    // Next acceleration: the largest one within the jerk limit that keeps the velocity limit and
+    // still lets the profile brake to rest on the target (feasibility is monotone in it)
+    float lo = constrain(a - _jMax * h, -_aMax, _aMax);
+    float hi = constrain(a + _jMax * h, -_aMax, _aMax);
+    float aNext = lo;
+    if (feasible(d, v, hi, h))
+    {
+        aNext = hi;
+    }
+    else if (feasible(d, v, lo, h))
+    {
+        for (int i = 0; i < BISECTION_STEPS; i++)
+        {
+            float mid = 0.5f * (lo + hi);
+            if (feasible(d, v, mid, h))
+                lo = mid;
+            else
+                hi = mid;
+        }
+        aNext = lo;
+    }
+
+    _a = s * aNext;
+    _v = s * (v + aNext * h);
+    _p += _v * h;
+    return _p;
+}
+
+bool TrajectoryGenerator::feasible(float d, float v, float a, float h)
+{
+    float vNext = v + a * h;
+    float vPeak = vNext + a * fabsf(a) / (2.0f * _jMax); // Velocity once the acceleration is ramped to 0
+    if (fabsf(vNext) > _vMax || fabsf(vPeak) > _vMax)
+    {
+        return false;
+    }
+    return vNext * h + stopDistance(vNext, a) <= d;
+}
+
+float TrajectoryGenerator::stopDistance(float v, float a)
+{
+    // Brake to rest with the limits: jerk -J down to a1, hold a1, jerk +J back to 0.
+    // Mirrored when the profile has to stop a motion away from the target
+    if (v + a * fabsf(a) / (2.0f * _jMax) < 0.0f)
+    {
+        return -stopDistance(-v, -a);
+    }
+
+    float J = _jMax;
+    float a1 = -sqrtf(J * v + 0.5f * a * a);
+    float t2 = 0.0f;
+    if (a1 < -_aMax)
+    {
+        a1 = -_aMax;
+        t2 = (v + a * a / (2.0f * J) - _aMax * _aMax / J) / _aMax;
+    }
+
+    float t1 = (a - a1) / J;
+    float d = v * t1 + 0.5f * a * t1 * t1 - J * t1 * t1 * t1 / 6.0f;
+    v += a * t1 - 0.5f * J * t1 * t1;
+    d += v * t2 + 0.5f * a1 * t2 * t2;
+    v += a1 * t2;
+    float t3 = -a1 / J;
+    d += v * t3 + 0.5f * a1 * t3 * t3 + J * t3 * t3 * t3 / 6.0f;
+    return d;
+}
+
+float TrajectoryGenerator::getPosition()
+{
+    return _p;
+}
+
+float TrajectoryGenerator::getVelocity()
+{
+    return _v;
+}
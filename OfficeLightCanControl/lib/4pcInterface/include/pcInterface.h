@@ -11,9 +11,11 @@
 #include <driver.h>     // Include driver header
 #include <localController.h>  // Include localController header
 #include <dataStorageMetrics.h> // Include 
+#include <metricsLog.h> // Include metricsLog header
 #include <CANHandler.h> // Include CANHandler header
 
 #define BUFFER_SIZE 64
+#define BUFFER_CHUNK 100 // The tier dump copies BUFFER_CHUNK / 2 windows per step
 
 // Command message IDs
 enum MessageType
@@ -88,13 +90,46 @@ enum MessageType
     MSG_AWN_BUFFER_Y,
     
     MSG_ACK,
-    MSG_ERROR
+    MSG_ERROR,
+
+    // Broadcast messages (no target desk ID in data[0])
+    MSG_DUTY_ANNOUNCE, // Applied duty cycle of the sender (float)
+    MSG_PERF_REPORT,   // Windowed performance figures of the sender (PerformanceMonitor::pack)
+
+    // Local-only commands (never relayed over CAN, so they may exceed the 6-bit CAN message ID)
+    MSG_GET_MPC = 64,     // g m
+    MSG_SET_MPC,          // m
+    MSG_GET_TRAJECTORY,   // g j
+    MSG_SET_TRAJECTORY,   // j
+    MSG_GET_NEIGHBOUR_FF, // g n
+    MSG_SET_NEIGHBOUR_FF, // n
+    MSG_GET_OBSERVER_BW,  // g e
+    MSG_SET_OBSERVER_BW,  // e
+    MSG_GET_CASCADE,      // g k
+    MSG_SET_CASCADE,      // k
+    MSG_GET_SMITH,        // g x
+    MSG_SET_SMITH,        // x
+    MSG_GET_EVENT,        // g w
+    MSG_SET_EVENT,        // w
+    MSG_GET_PERFORMANCE,  // g P
+    MSG_GET_STRATEGY,     // g c
+    MSG_SET_STRATEGY,     // c
+    MSG_GET_HISTORY,      // g h <tier>
+    MSG_GET_METRICS_LOG,  // g l
+    MSG_GET_WINDOW_METRICS, // g W
+    MSG_GET_RANGE_METRICS,  // g R <t0> <t1>
+    MSG_GET_QUANTILES,      // g Q
+    MSG_GET_JITTER,         // g J
+    MSG_GET_EVENTS,         // g H
+    MSG_GET_RECORDER        // g s [<channel>]
 };
 
+static_assert(MSG_PERF_REPORT < 64, "CAN message IDs are limited to 6 bits");
+
 class pcInterface {
 public:
     pcInterface(LuxMeter &luxM, Driver &driv, localController &ctrl,
-                dataStorageMetrics &storage, CANHandler &canHandler);
+                dataStorageMetrics &storage, MetricsLog &log, CANHandler &canHandler);
 
     void begin(uint32_t baudRate);
     void processSerial();
@@ -102,6 +137,15 @@ public:
 
     void processIncomingCANMessages();
 
+    // Broadcast the applied duty cycle over CAN when it changes
+    void announceDutyCycle(float u);
+
+    // Print the step response figures once the response to a reference change settled
+    void reportStepResponse();
+
+    // Broadcast the windowed performance figures over CAN every PERF_PUBLISH_INTERVAL
+    void publishPerformance(unsigned long time);
+
     // ID management
     int myDeskId;
     void myIdInit(int id);
@@ -116,6 +160,7 @@ private:
     Driver& driver;
     localController& controller;    
     dataStorageMetrics& dataSt;
+    MetricsLog& metricsLog;
     CANHandler& canHandler;
 
     char commandBuffer[BUFFER_SIZE];
@@ -126,6 +171,19 @@ private:
     bool streaming_r = false;
     bool streaming_v = false;
 
+    static constexpr float DUTY_ANNOUNCE_THRESHOLD = 0.002f; // Minimum duty change to broadcast
+    float lastAnnouncedDuty = -1.0f;
+
+    static constexpr unsigned long PERF_PUBLISH_INTERVAL = 1000; // ms
+    static constexpr int PERF_CACHE_SIZE = 32;                   // One entry per 5-bit desk ID
+    unsigned long lastPerfPublish = 0;
+    uint8_t perfCache[PERF_CACHE_SIZE][8];     // Last performance report of each desk
+    bool perfCacheValid[PERF_CACHE_SIZE] = {};
+
+    void printPerformance(int deskId, const float *values);
+    void printLoopTiming(const LoopTiming &timing);
+    void printBuffer(char signal, const std::vector<std::string> &tokens);
+
     void parseCommand(const char* cmd);
 
     void handleCommand(MessageType msgType, std::vector<std::string> tokens);
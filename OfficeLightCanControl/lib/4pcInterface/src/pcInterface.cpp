@@ -2,9 +2,9 @@
 
 pcInterface::pcInterface(LuxMeter &luxM, Driver &driv,
                          localController &ctrl, dataStorageMetrics &storage,
-                         CANHandler &canHandler)
+                         MetricsLog &log, CANHandler &canHandler)
     : luxMeter(luxM), driver(driv),
-      controller(ctrl), dataSt(storage), canHandler(canHandler)
+      controller(ctrl), dataSt(storage), metricsLog(log), canHandler(canHandler)
 {
 }
 
@@ -68,12 +68,38 @@ void pcInterface::processIncomingCANMessages()
     bool success = false;
     MessageType msgType;
 
-    if (canHandler.readMessage(&messageId, &senderDeskId, data, &length))
+    // Drain every pending frame so duty announcements are applied in the same tick
+    while (canHandler.readMessage(&messageId, &senderDeskId, data, &length))
     {
+        success = false;
+        msgType = static_cast<MessageType>(messageId);
+
+        // Broadcast frames carry no target desk ID
+        if (msgType == MSG_DUTY_ANNOUNCE)
+        {
+            if (length == sizeof(float))
+            {
+                memcpy(&floatValue, data, sizeof(float));
+                if (isfinite(floatValue))
+                {
+                    controller.setNeighbourDuty(senderDeskId, constrain(floatValue, 0.0f, 1.0f));
+                }
+            }
+            continue;
+        }
+        if (msgType == MSG_PERF_REPORT)
+        {
+            if (length == 8 && senderDeskId < PERF_CACHE_SIZE)
+            {
+                memcpy(perfCache[senderDeskId], data, 8);
+                perfCacheValid[senderDeskId] = true;
+            }
+            continue;
+        }
+
         if (length < 1 || data[0] != myDeskId)
-            return;
+            continue;
 
-        msgType = static_cast<MessageType>(messageId);
         switch (msgType)
         {
         case MSG_GET_DUTY_CYCLE:
@@ -358,7 +384,7 @@ void pcInterface::processIncomingCANMessages()
             break;
         case MSG_ERROR:
         default:
-            return;
+            continue;
         }
 
         if (success)
@@ -368,6 +394,118 @@ void pcInterface::processIncomingCANMessages()
     }
 }
 
+void pcInterface::announceDutyCycle(float u)
+{
+    // Broadcast only on change, neighbours use it as feedforward (K_j * du_j)
+    if (fabsf(u - lastAnnouncedDuty) < DUTY_ANNOUNCE_THRESHOLD)
+        return;
+
+    if (canHandler.sendMessage(MSG_DUTY_ANNOUNCE, myDeskId, reinterpret_cast<uint8_t *>(&u), sizeof(float)))
+    {
+        lastAnnouncedDuty = u;
+    }
+}
+
+void pcInterface::reportStepResponse()
+{
+    StepAnalyser &analyser = controller.getStepAnalyser();
+    if (!analyser.consumeReport())
+        return;
+
+    // sr <i> <step> <rise time> <overshoot %> <settling time> <steady-state error>
+    Serial.printf("sr %d %.2f %.3f %.2f %.3f %.3f\n", myDeskId, analyser.getStep(), analyser.getRiseTime(),
+                  analyser.getOvershoot(), analyser.getSettlingTime(), analyser.getSteadyStateError());
+}
+
+void pcInterface::publishPerformance(unsigned long time)
+{
+    if (time - lastPerfPublish < PERF_PUBLISH_INTERVAL)
+        return;
+    lastPerfPublish = time;
+
+    uint8_t data[8];
+    dataSt.getPerformanceMonitor().pack(data);
+    canHandler.sendMessage(MSG_PERF_REPORT, myDeskId, data, sizeof(data));
+}
+
+void pcInterface::printPerformance(int deskId, const float *values)
+{
+    // P <i> <IAE> <ISE> <ITAE> <saturation fraction> <crossings per second>
+    Serial.printf("P %d %.3f %.3f %.3f %.3f %.2f\n", deskId, values[0], values[1], values[2], values[3], values[4]);
+}
+
+void pcInterface::printLoopTiming(const LoopTiming &timing)
+{
+    // J <i> <target us> <steps> <misses> <mean period> <worst period> <at ms> <worst execution> <at ms>
+    // then the non-empty histogram bins as <lower us>:<count>, p for the period, x for the execution time
+    uint32_t target = timing.getTargetPeriod();
+    Serial.printf("J %d %lu %lu %lu %lu %lu %lu %lu %lu\n", myDeskId, (unsigned long)target,
+                  (unsigned long)timing.getSteps(), (unsigned long)timing.getMisses(),
+                  (unsigned long)timing.getMeanPeriod(), (unsigned long)timing.getWorstPeriod(),
+                  timing.getWorstPeriodTime(), (unsigned long)timing.getWorstExecution(),
+                  timing.getWorstExecutionTime());
+
+    Serial.printf("J %d %lu p", myDeskId, (unsigned long)target);
+    for (uint8_t i = 0; i < LoopTiming::BIN_COUNT; i++)
+    {
+        if (timing.getPeriodBin(i))
+            Serial.printf(" %lu:%lu", (unsigned long)LoopTiming::getBinLower(i), (unsigned long)timing.getPeriodBin(i));
+    }
+    Serial.printf("\nJ %d %lu x", myDeskId, (unsigned long)target);
+    for (uint8_t i = 0; i < LoopTiming::BIN_COUNT; i++)
+    {
+        if (timing.getExecutionBin(i))
+            Serial.printf(" %lu:%lu", (unsigned long)LoopTiming::getBinLower(i), (unsigned long)timing.getExecutionBin(i));
+    }
+    Serial.printf("\n");
+}
+
+void pcInterface::printBuffer(char signal, const std::vector<std::string> &tokens)
+{
+    // g b <u|y> [<t0> <t1> [<k>]] <i>
+    int ID = atoi(tokens.back().c_str());
+    if (isNotValidID(ID))
+    {
+        sendResponse(MSG_ERROR, "invalid desk ID %d", ID);
+        return;
+    }
+
+    // Decoded sample by sample straight from the compressed history, no copy
+    CompressedHistory::Cursor cursor;
+    if (tokens.size() >= 6)
+    {
+        int t0 = atoi(tokens[3].c_str());
+        int t1 = atoi(tokens[4].c_str());
+        int k = tokens.size() >= 7 ? atoi(tokens[5].c_str()) : 1;
+        if (t1 < t0 || k < 1)
+        {
+            sendResponse(MSG_ERROR, "invalid buffer range %d %d %d", t0, t1, k);
+            return;
+        }
+        cursor = dataSt.getHistoryRange(t0, t1, k);
+        Serial.printf("b %c %d %d %d %d\n", signal, ID, t0, t1, k);
+    }
+    else
+    {
+        cursor = dataSt.getHistoryView().begin();
+        Serial.printf("b %c %d\n", signal, ID);
+    }
+
+    sampleRecord sample;
+    bool firstSample = true;
+    while (cursor.next(sample))
+    {
+        float value = signal == 'u' ? dataStorageMetrics::unpackDuty(sample.u) : dataStorageMetrics::unpackLux(sample.y);
+        Serial.printf(firstSample ? "%0.2f" : (signal == 'u' ? ", %0.2f" : " ,%0.2f"), value);
+        firstSample = false;
+    }
+    Serial.printf("\n");
+    if (cursor.overrun())
+    {
+        sendResponse(MSG_ERROR, "buffer overwritten during export");
+    }
+}
+
 void pcInterface::myIdInit(int id)
 {
     myDeskId = id;
@@ -400,7 +538,7 @@ void pcInterface::parseCommand(const char *cmd)
     std::string token;
     std::vector<std::string> tokens;
 
-    while (tokens.size() < 5 && std::getline(ss, token, ' '))
+    while (tokens.size() < 7 && std::getline(ss, token, ' '))
     {
         tokens.push_back(token);
     }
@@ -464,6 +602,54 @@ void pcInterface::parseCommand(const char *cmd)
             msgType = MSG_GET_CURRENT_LOWER_BOUND;
         else if (tokens[1] == "C")
             msgType = MSG_GET_ENERGY_COST;
+        else if (tokens[1] == "m")
+            msgType = MSG_GET_MPC;
+        else if (tokens[1] == "j")
+            msgType = MSG_GET_TRAJECTORY;
+        else if (tokens[1] == "n")
+            msgType = MSG_GET_NEIGHBOUR_FF;
+        else if (tokens[1] == "e")
+            msgType = MSG_GET_OBSERVER_BW;
+        else if (tokens[1] == "k")
+            msgType = MSG_GET_CASCADE;
+        else if (tokens[1] == "x")
+            msgType = MSG_GET_SMITH;
+        else if (tokens[1] == "w")
+            msgType = MSG_GET_EVENT;
+        else if (tokens[1] == "P")
+            msgType = MSG_GET_PERFORMANCE;
+        else if (tokens[1] == "c")
+            msgType = MSG_GET_STRATEGY;
+        else if (tokens[1] == "l")
+            msgType = MSG_GET_METRICS_LOG;
+        else if (tokens[1] == "W")
+            msgType = MSG_GET_WINDOW_METRICS;
+        else if (tokens[1] == "Q")
+            msgType = MSG_GET_QUANTILES;
+        else if (tokens[1] == "J")
+            msgType = MSG_GET_JITTER;
+        else if (tokens[1] == "H")
+            msgType = MSG_GET_EVENTS;
+        else if (tokens[1] == "s")
+            msgType = MSG_GET_RECORDER;
+        else if (tokens[1] == "R")
+        {
+            if (tokens.size() < 5)
+            {
+                sendResponse(MSG_ERROR, "invalid get range command");
+                return;
+            }
+            msgType = MSG_GET_RANGE_METRICS;
+        }
+        else if (tokens[1] == "h")
+        {
+            if (tokens.size() < 4)
+            {
+                sendResponse(MSG_ERROR, "invalid get history command");
+                return;
+            }
+            msgType = MSG_GET_HISTORY;
+        }
         else if (tokens[1] == "b")
         {
             if (tokens.size() < 3)
@@ -559,6 +745,46 @@ void pcInterface::parseCommand(const char *cmd)
         msgType = MSG_SET_ENERGY_COST;
         targetDeskId = extractDeskId(tokens[1].c_str());
     }
+    else if (tokens[0] == "m")
+    {
+        msgType = MSG_SET_MPC;
+        targetDeskId = extractDeskId(tokens[1].c_str());
+    }
+    else if (tokens[0] == "j")
+    {
+        msgType = MSG_SET_TRAJECTORY;
+        targetDeskId = extractDeskId(tokens[1].c_str());
+    }
+    else if (tokens[0] == "n")
+    {
+        msgType = MSG_SET_NEIGHBOUR_FF;
+        targetDeskId = extractDeskId(tokens[1].c_str());
+    }
+    else if (tokens[0] == "e")
+    {
+        msgType = MSG_SET_OBSERVER_BW;
+        targetDeskId = extractDeskId(tokens[1].c_str());
+    }
+    else if (tokens[0] == "k")
+    {
+        msgType = MSG_SET_CASCADE;
+        targetDeskId = extractDeskId(tokens[1].c_str());
+    }
+    else if (tokens[0] == "x")
+    {
+        msgType = MSG_SET_SMITH;
+        targetDeskId = extractDeskId(tokens[1].c_str());
+    }
+    else if (tokens[0] == "w")
+    {
+        msgType = MSG_SET_EVENT;
+        targetDeskId = extractDeskId(tokens[1].c_str());
+    }
+    else if (tokens[0] == "c")
+    {
+        msgType = MSG_SET_STRATEGY;
+        targetDeskId = extractDeskId(tokens[1].c_str());
+    }
     if (msgType == MSG_ERROR)
     {
         sendResponse(MSG_ERROR, "unknown command %s", tokens[0].c_str());
@@ -683,39 +909,152 @@ void pcInterface::handleCommand(MessageType msgType, std::vector<std::string> to
         break;
     }
     case MSG_GET_BUFFER_U:
+        printBuffer('u', tokens);
+        break;
+    case MSG_GET_BUFFER_Y:
+        printBuffer('y', tokens);
+        break;
+    case MSG_GET_HISTORY:
     {
-        int ID = atoi(tokens[3].c_str());
-        if (isNotValidID(ID))
+        int tier = atoi(tokens[2].c_str());
+        uint32_t period = dataSt.getTierPeriod(tier);
+        if (period == 0)
         {
-            sendResponse(MSG_ERROR, "invalid desk ID %d", ID);
+            sendResponse(MSG_ERROR, "invalid history tier %d", tier);
             return;
         }
-        float uData[6000];
-        uint16_t elements = dataSt.getUbuffer(uData);
-        Serial.printf("b u %d\n", ID);
-        for (uint16_t i = 0; i < elements - 1; i++)
+
+        // h <tier> <i> <window ms>, then one line per window: <start ms> <u min mean max> <y min mean max>
+        historyEntry entries[BUFFER_CHUNK / 2];
+        uint16_t elements = dataSt.getTierCount(tier);
+        Serial.printf("h %d %d %lu\n", tier, myDeskId, (unsigned long)period);
+        for (uint16_t first = 0; first < elements; first += BUFFER_CHUNK / 2)
         {
-            Serial.printf("%0.2f, ", uData[i]);
+            int start = 0;
+            uint16_t n = dataSt.getTier(tier, entries, first, BUFFER_CHUNK / 2, &start);
+            for (uint16_t i = 0; i < n; i++, start += period)
+            {
+                const historyEntry &e = entries[i];
+                if (e.isEmpty())
+                {
+                    Serial.printf("%d -\n", start); // No samples in this window
+                    continue;
+                }
+                Serial.printf("%d %.4f %.4f %.4f %.2f %.2f %.2f\n", start,
+                              dataStorageMetrics::unpackDuty(e.uMin), dataStorageMetrics::unpackDuty(e.uMean),
+                              dataStorageMetrics::unpackDuty(e.uMax), dataStorageMetrics::unpackLux(e.yMin),
+                              dataStorageMetrics::unpackLux(e.yMean), dataStorageMetrics::unpackLux(e.yMax));
+            }
         }
-        Serial.printf("%0.2f\n", uData[elements - 1]);
         break;
     }
-    case MSG_GET_BUFFER_Y:
+    case MSG_GET_METRICS_LOG:
+    {
+        // l <i> <records>, then one line per minute in flash, oldest first:
+        // <sequence> <start ms> <u min mean max> <y min mean max> <energy J>
+        metricsState state;
+        uint32_t sequence;
+        Serial.printf("l %d %lu\n", myDeskId, (unsigned long)MetricsLog::SLOT_COUNT);
+        for (uint32_t n = 0; n < MetricsLog::SLOT_COUNT; n++)
+        {
+            if (!metricsLog.getRecord(n, state, sequence))
+            {
+                continue;
+            }
+            const historyEntry &e = state.minute;
+            Serial.printf("%lu %d %.4f %.4f %.4f %.2f %.2f %.2f %.4f\n", (unsigned long)sequence, state.minuteStart,
+                          dataStorageMetrics::unpackDuty(e.uMin), dataStorageMetrics::unpackDuty(e.uMean),
+                          dataStorageMetrics::unpackDuty(e.uMax), dataStorageMetrics::unpackLux(e.yMin),
+                          dataStorageMetrics::unpackLux(e.yMean), dataStorageMetrics::unpackLux(e.yMax),
+                          state.energySum * dataStorageMetrics::LED_MAX_POWER);
+        }
+        break;
+    }
+    case MSG_GET_WINDOW_METRICS:
+    {
+        // One line per window: W <i> <window s> <energy J> <visibility error LUX> <flicker s^-1>
+        for (uint8_t window = 0; dataSt.getWindowLength(window) > 0; window++)
+        {
+            Serial.printf("W %d %lu %.4f %.4f %.6f\n", myDeskId, (unsigned long)dataSt.getWindowLength(window) / 1000,
+                          dataSt.getWindowEnergy(window), dataSt.getWindowVisibilityError(window),
+                          dataSt.getWindowFlicker(window));
+        }
+        break;
+    }
+    case MSG_GET_RANGE_METRICS:
     {
-        int ID = atoi(tokens[3].c_str());
-        if (isNotValidID(ID))
+        // R <i> <start ms> <end ms> <energy J> <visibility error LUX> <flicker s^-1>,
+        // start and end are the 1 s checkpoints actually covered
+        rangeMetrics range;
+        int t0 = atoi(tokens[2].c_str());
+        int t1 = atoi(tokens[3].c_str());
+        if (!dataSt.getRangeMetrics(t0, t1, range))
         {
-            sendResponse(MSG_ERROR, "invalid desk ID %d", ID);
+            sendResponse(MSG_ERROR, "range %d %d not in history", t0, t1);
             return;
         }
-        float yData[6000];
-        uint16_t elements = dataSt.getYbuffer(yData);
-        Serial.printf("b y %d\n", ID);
-        for (uint16_t i = 0; i < elements - 1; i++)
+        Serial.printf("R %d %d %d %.4f %.4f %.6f\n", myDeskId, range.start, range.end,
+                      range.energy, range.visibilityError, range.flicker);
+        break;
+    }
+    case MSG_GET_QUANTILES:
+    {
+        // Q <i> <signal> <samples> <p50> <p90> <p99>, e: |r - y| in LUX, t: loop time in us
+        const QuantileSketch &error = dataSt.getErrorQuantiles();
+        const QuantileSketch &loopTime = dataSt.getLoopTimeQuantiles();
+        Serial.printf("Q %d e %lu %.3f %.3f %.3f\n", myDeskId, (unsigned long)error.getCount(),
+                      error.getQuantile(0.5f), error.getQuantile(0.9f), error.getQuantile(0.99f));
+        Serial.printf("Q %d t %lu %.0f %.0f %.0f\n", myDeskId, (unsigned long)loopTime.getCount(),
+                      loopTime.getQuantile(0.5f), loopTime.getQuantile(0.9f), loopTime.getQuantile(0.99f));
+        break;
+    }
+    case MSG_GET_JITTER:
+    {
+        printLoopTiming(dataSt.getSampleTiming());
+        printLoopTiming(dataSt.getControlTiming());
+        break;
+    }
+    case MSG_GET_EVENTS:
+    {
+        // H <i> <records>, then one line per change, oldest first: <ms> <setting letter> <value>
+        const EventLog &events = dataSt.getEventLog();
+        Serial.printf("H %d %d\n", myDeskId, events.getCount());
+        for (uint8_t i = 0; i < events.getCount(); i++)
         {
-            Serial.printf("%0.2f ,", yData[i]);
+            const eventRecord &e = events.get(i);
+            Serial.printf("%d %c %.2f\n", e.timestamp, EventLog::getLetter(e.type), e.value);
+        }
+        break;
+    }
+    case MSG_GET_RECORDER:
+    {
+        const dataStorageMetrics::Recorder &recorder = dataSt.getRecorder();
+        if (tokens.size() < 4)
+        {
+            // s <i> <channels>, then one line per channel: <name> <period ms> <samples held> <capacity>
+            Serial.printf("s %d %d\n", myDeskId, (int)dataStorageMetrics::Recorder::CHANNEL_COUNT);
+            for (size_t c = 0; c < dataStorageMetrics::Recorder::CHANNEL_COUNT; c++)
+            {
+                const channelSpec &spec = recorder.getChannel(c);
+                Serial.printf("%s %lu %lu %u\n", spec.name, (unsigned long)(spec.decimation * recorderSchema::PERIOD_MS),
+                              (unsigned long)recorder.getCount(c), spec.length);
+            }
+            break;
+        }
+
+        // s <channel> <i> <samples>, then one line per sample, oldest first: <ms> <value>
+        int channel = recorder.findChannel(tokens[2].c_str());
+        if (channel < 0)
+        {
+            sendResponse(MSG_ERROR, "unknown recorder channel %s", tokens[2].c_str());
+            return;
+        }
+        uint32_t count = recorder.getCount(channel);
+        Serial.printf("s %s %d %lu\n", tokens[2].c_str(), myDeskId, (unsigned long)count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            Serial.printf("%d %.4f\n", recorder.getSampleTime(channel, i), recorder.getSample(channel, i));
         }
-        Serial.printf("%0.2f\n", yData[elements - 1]);
         break;
     }
     case MSG_SET_DUTY_CYCLE:
@@ -858,6 +1197,225 @@ void pcInterface::handleCommand(MessageType msgType, std::vector<std::string> to
         sendResponse(MSG_ACK, "ack");
         break;
     }
+    case MSG_GET_MPC:
+    {
+        sendDataResponse(MSG_GET_MPC, myDeskId, (int)controller.getMpc());
+        break;
+    }
+    case MSG_SET_MPC:
+    {
+        if (tokens.size() < 3)
+        {
+            sendResponse(MSG_ERROR, "invalid set command");
+            return;
+        }
+
+        int value = atoi(tokens[2].c_str());
+        if (value == 0)
+            controller.setMpc(false);
+        else if (value == 1)
+            controller.setMpc(true);
+        else
+        {
+            sendResponse(MSG_ERROR, "invalid mpc value %d", value);
+            return;
+        }
+        sendResponse(MSG_ACK, "ack");
+        break;
+    }
+    case MSG_GET_TRAJECTORY:
+    {
+        sendDataResponse(MSG_GET_TRAJECTORY, myDeskId, (int)controller.getTrajectory());
+        break;
+    }
+    case MSG_SET_TRAJECTORY:
+    {
+        if (tokens.size() < 3)
+        {
+            sendResponse(MSG_ERROR, "invalid set command");
+            return;
+        }
+
+        int value = atoi(tokens[2].c_str());
+        if (value == 0)
+            controller.setTrajectory(false);
+        else if (value == 1)
+            controller.setTrajectory(true);
+        else
+        {
+            sendResponse(MSG_ERROR, "invalid trajectory value %d", value);
+            return;
+        }
+        sendResponse(MSG_ACK, "ack");
+        break;
+    }
+    case MSG_GET_NEIGHBOUR_FF:
+    {
+        sendDataResponse(MSG_GET_NEIGHBOUR_FF, myDeskId, (int)controller.getNeighbourFeedforward());
+        break;
+    }
+    case MSG_SET_NEIGHBOUR_FF:
+    {
+        if (tokens.size() < 3)
+        {
+            sendResponse(MSG_ERROR, "invalid set command");
+            return;
+        }
+
+        int value = atoi(tokens[2].c_str());
+        if (value == 0)
+            controller.setNeighbourFeedforward(false);
+        else if (value == 1)
+            controller.setNeighbourFeedforward(true);
+        else
+        {
+            sendResponse(MSG_ERROR, "invalid neighbour feedforward value %d", value);
+            return;
+        }
+        sendResponse(MSG_ACK, "ack");
+        break;
+    }
+    case MSG_GET_OBSERVER_BW:
+    {
+        sendDataResponse(MSG_GET_OBSERVER_BW, myDeskId, controller.getObserverBandwidth());
+        break;
+    }
+    case MSG_SET_OBSERVER_BW:
+    {
+        if (tokens.size() < 3)
+        {
+            sendResponse(MSG_ERROR, "invalid set command");
+            return;
+        }
+
+        float value = extractValue(tokens[2].c_str());
+        if (value <= 0.0f)
+        {
+            sendResponse(MSG_ERROR, "invalid observer bandwidth value %f", value);
+            return;
+        }
+        controller.setObserverBandwidth(value);
+        sendResponse(MSG_ACK, "ack");
+        break;
+    }
+    case MSG_GET_CASCADE:
+    {
+        sendDataResponse(MSG_GET_CASCADE, myDeskId, (int)controller.getCascade());
+        break;
+    }
+    case MSG_SET_CASCADE:
+    {
+        if (tokens.size() < 3)
+        {
+            sendResponse(MSG_ERROR, "invalid set command");
+            return;
+        }
+
+        int value = atoi(tokens[2].c_str());
+        if (value == 0)
+            controller.setCascade(false);
+        else if (value == 1)
+            controller.setCascade(true);
+        else
+        {
+            sendResponse(MSG_ERROR, "invalid cascade value %d", value);
+            return;
+        }
+        sendResponse(MSG_ACK, "ack");
+        break;
+    }
+    case MSG_GET_SMITH:
+    {
+        sendDataResponse(MSG_GET_SMITH, myDeskId, (int)controller.getSmith());
+        break;
+    }
+    case MSG_SET_SMITH:
+    {
+        // x <i> <0|1> [delay in ticks]
+        if (tokens.size() < 3)
+        {
+            sendResponse(MSG_ERROR, "invalid set command");
+            return;
+        }
+
+        int value = atoi(tokens[2].c_str());
+        if (value != 0 && value != 1)
+        {
+            sendResponse(MSG_ERROR, "invalid smith value %d", value);
+            return;
+        }
+        if (tokens.size() > 3)
+        {
+            int delay = atoi(tokens[3].c_str());
+            if (delay < 0 || delay > 15)
+            {
+                sendResponse(MSG_ERROR, "invalid smith delay %d", delay);
+                return;
+            }
+            controller.setSmithDelay(delay);
+        }
+        controller.setSmith(value == 1);
+        sendResponse(MSG_ACK, "ack");
+        break;
+    }
+    case MSG_GET_EVENT:
+    {
+        // w <i> <mode> <computed ticks> <skipped ticks>
+        Serial.printf("w %d %d %lu %lu\n", myDeskId, (int)controller.getEventTriggered(),
+                      (unsigned long)controller.getEventTicks(), (unsigned long)controller.getEventSkips());
+        break;
+    }
+    case MSG_SET_EVENT:
+    {
+        if (tokens.size() < 3)
+        {
+            sendResponse(MSG_ERROR, "invalid set command");
+            return;
+        }
+
+        int value = atoi(tokens[2].c_str());
+        if (value == 0)
+            controller.setEventTriggered(false);
+        else if (value == 1)
+            controller.setEventTriggered(true);
+        else
+        {
+            sendResponse(MSG_ERROR, "invalid event value %d", value);
+            return;
+        }
+        sendResponse(MSG_ACK, "ack");
+        break;
+    }
+    case MSG_GET_PERFORMANCE:
+    {
+        PerformanceMonitor &monitor = dataSt.getPerformanceMonitor();
+        float values[5] = {monitor.getIAE(), monitor.getISE(), monitor.getITAE(),
+                           monitor.getSaturation(), monitor.getOscillation()};
+        printPerformance(myDeskId, values);
+        break;
+    }
+    case MSG_GET_STRATEGY:
+        // 0 PID, 1 integrator only, 2 feedforward only, 3 distributed
+        sendDataResponse(msgType, myDeskId, (int)controller.getStrategy());
+        break;
+    case MSG_SET_STRATEGY:
+    {
+        if (tokens.size() < 3)
+        {
+            sendResponse(MSG_ERROR, "invalid set command");
+            return;
+        }
+
+        int value = atoi(tokens[2].c_str());
+        if (value < 0 || value >= STRATEGY_COUNT)
+        {
+            sendResponse(MSG_ERROR, "invalid strategy %d", value);
+            return;
+        }
+        controller.setStrategy(static_cast<ControlStrategy>(value));
+        sendResponse(MSG_ACK, "ack");
+        break;
+    }
     case MSG_STREAM_START_U:
     {
         streaming_u = true;
@@ -999,6 +1557,9 @@ void pcInterface::sendDataResponse(MessageType msgType, int deskId, float value)
     case MSG_AWN_ENERGY_COST:
         Serial.printf("C %d %.2f\n", deskId, value);
         break;
+    case MSG_GET_OBSERVER_BW:
+        Serial.printf("e %d %.2f\n", deskId, value);
+        break;
     default:
         break;
     }
@@ -1020,6 +1581,24 @@ void pcInterface::sendDataResponse(MessageType msgType, int deskId, int value)
     case MSG_AWN_F:
         Serial.printf("f %d %d\n", deskId, value);
         break;
+    case MSG_GET_MPC:
+        Serial.printf("m %d %d\n", deskId, value);
+        break;
+    case MSG_GET_TRAJECTORY:
+        Serial.printf("j %d %d\n", deskId, value);
+        break;
+    case MSG_GET_NEIGHBOUR_FF:
+        Serial.printf("n %d %d\n", deskId, value);
+        break;
+    case MSG_GET_CASCADE:
+        Serial.printf("k %d %d\n", deskId, value);
+        break;
+    case MSG_GET_SMITH:
+        Serial.printf("x %d %d\n", deskId, value);
+        break;
+    case MSG_GET_STRATEGY:
+        Serial.printf("c %d %d\n", deskId, value);
+        break;
     default:
         break;
     }
@@ -1057,6 +1636,18 @@ void pcInterface::handleRemoteCommand(MessageType msgType, uint8_t targetDeskId,
             sendResponse(MSG_ERROR, "failed to send command to desk %d", targetDeskId);
         }
     }
+    else if (msgType == MSG_GET_PERFORMANCE)
+    {
+        // Answered from the last broadcast report of that desk
+        if (targetDeskId >= PERF_CACHE_SIZE || !perfCacheValid[targetDeskId])
+        {
+            sendResponse(MSG_ERROR, "no performance report from desk %d", targetDeskId);
+            return;
+        }
+        float values[5];
+        PerformanceMonitor::unpack(perfCache[targetDeskId], values);
+        printPerformance(targetDeskId, values);
+    }
     else
     {
         sendResponse(MSG_ERROR, "remote command not supported");
@@ -0,0 +1,147 @@
+#ifndef COMPRESSED_HISTORY_H
+#define COMPRESSED_HISTORY_H
+
+#include <stdint.h>
+
+// One decoded sample (duty cycle and lux in the dataStorageMetrics fixed point)
+struct sampleRecord
+{
+    int timestamp; // ms
+    uint16_t u;    // Duty cycle, 1/65535
+    uint16_t y;    // Lux, 1/100 LUX
+};
+
+// CompressedHistory class definition
+// Append-only sample history in a ring of fixed-size blocks, the oldest block is evicted whole.
+// Every block starts with its first sample in full, so it decodes on its own.
+// The following samples are stored as zigzag varints of
+// - the delta-of-delta of the timestamp (0 at a steady rate, 1 byte)
+// - the delta of u and y to the previous sample (slowly varying, mostly 1 byte)
+// Readers never copy: a View marks the blocks held and hands out forward cursors that decode
+// them in place. Every evicted block bumps a sequence number, so a cursor detects that the
+// block it reads was overwritten meanwhile.
+// methods :
+// - append: encode one sample, O(1)
+// - getCount: number of samples held
+// - getView: read-only snapshot of the blocks held
+// - begin: sequential reader starting at the first-th oldest sample
+// - View::range: sequential reader over a time range, optionally decimated
+class CompressedHistory
+{
+public:
+    static const uint16_t BLOCK_BYTES = 128;  // Block size including the header
+    static const uint16_t BLOCK_COUNT = 512;  // 64 KB, a power of two so the ring index is masked
+    static const uint8_t PAYLOAD_BYTES = BLOCK_BYTES - 10;
+    // Samples per block at steady state: constant rate and |du|, |dy| < 64 LSB, one byte per varint
+    static const uint16_t STEADY_BLOCK_SAMPLES = 1 + PAYLOAD_BYTES / 3;
+    static const uint32_t STEADY_SAMPLES = (uint32_t)BLOCK_COUNT * STEADY_BLOCK_SAMPLES; // 20480, 205 s at 100 Hz
+
+    // Sequential decoder over the samples of a view, samples appended later are not seen
+    class Cursor
+    {
+    public:
+        // Decode the next sample, returns false at the end or once the view was overwritten
+        bool next(sampleRecord &out);
+
+        // Returns true if the block being read was evicted (the samples read so far are good)
+        bool overrun() const { return _overrun; }
+
+    private:
+        friend class CompressedHistory;
+        const CompressedHistory *_history;
+        uint32_t _sequence;  // Eviction count when the view was taken
+        uint16_t _index;     // Blocks of the view already passed
+        uint16_t _block;     // Ring index of the current block
+        uint16_t _blocksLeft; // Blocks left including the current one
+        uint8_t _lastCount;  // Samples of the newest block when the view was taken
+        uint8_t _sample;     // Samples of the current block already decoded
+        uint8_t _offset;     // Byte offset in the current block payload
+        bool _overrun;
+        int _end;            // Last timestamp returned (range readers)
+        uint16_t _stride;    // Return one sample out of _stride
+        int _t, _delta;
+        uint16_t _u, _y;
+
+        // Decode the next sample of the view
+        bool decode(sampleRecord &out);
+    };
+
+    // Read-only snapshot of the blocks held, stays valid until its oldest block is evicted
+    class View
+    {
+    public:
+        // Get a reader positioned at the first-th oldest sample of the view
+        Cursor begin(uint16_t first = 0) const;
+
+        // Get a reader over the samples with t0 <= timestamp <= t1, one out of every stride
+        // (binary search on the block start times, then at most one block decoded)
+        Cursor range(int t0, int t1, uint16_t stride = 1) const;
+
+        // Get number of samples in the view when it was taken
+        uint16_t getCount() const { return _count; }
+
+    private:
+        friend class CompressedHistory;
+        const CompressedHistory *_history;
+        uint32_t _sequence;
+        uint16_t _oldest, _blockCount, _count;
+        uint8_t _lastCount;
+
+        // Reader at the start of the index-th block of the view
+        Cursor blockCursor(uint16_t index) const;
+    };
+
+    CompressedHistory();
+
+    // Encode one sample (timestamps must not decrease)
+    void append(int timestamp, uint16_t u, uint16_t y);
+
+    // Get number of samples held
+    uint16_t getCount() const;
+
+    // Get a read-only view of the blocks held
+    View getView() const;
+
+    // Get a reader positioned at the first-th oldest sample
+    Cursor begin(uint16_t first = 0) const;
+
+    // Get number of blocks evicted since boot (changes whenever stored data is overwritten)
+    uint32_t getSequence() const { return _sequence; }
+
+    // Get bytes of block storage in use (header and payload)
+    uint32_t getBytesUsed() const;
+
+private:
+    static const uint16_t BLOCK_MASK = BLOCK_COUNT - 1;
+    static_assert((BLOCK_COUNT & BLOCK_MASK) == 0, "BLOCK_COUNT must be a power of two");
+
+    struct block
+    {
+        int32_t firstTime;         // First sample in full
+        uint16_t firstU, firstY;
+        uint8_t count;             // Samples in the block
+        uint8_t used;              // Payload bytes in use
+        uint8_t data[PAYLOAD_BYTES];
+    };
+    static_assert(sizeof(block) == BLOCK_BYTES, "block must be BLOCK_BYTES");
+
+    block _blocks[BLOCK_COUNT];
+    uint16_t _oldest;      // Ring index of the oldest block
+    uint16_t _blockCount;  // Blocks in use
+    uint16_t _count;       // Samples held
+    uint32_t _sequence;    // Blocks evicted, bumped before the block is reused
+
+    // Encoder state of the newest block
+    int _lastT, _lastDelta;
+    uint16_t _lastU, _lastY;
+
+    // Start a new block with a sample in full (evicts the oldest block when the ring is full)
+    void startBlock(int timestamp, uint16_t u, uint16_t y);
+
+    static uint8_t putVarint(uint8_t *out, uint32_t value);
+    static uint32_t getVarint(const uint8_t *in, uint8_t &offset);
+    static uint32_t zigzag(int32_t value) { return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31); }
+    static int32_t unzigzag(uint32_t value) { return (int32_t)(value >> 1) ^ -(int32_t)(value & 1); }
+};
+
+#endif
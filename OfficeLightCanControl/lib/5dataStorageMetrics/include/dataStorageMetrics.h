@@ -3,10 +3,32 @@
 
 #include <stdint.h>
 #include <cstdlib>
-
+#include "performanceMonitor.h"
+#include "historyTier.h"
+#include "compressedHistory.h"
+#include "slidingMetrics.h"
+#include "metricsIndex.h"
+#include "quantileSketch.h"
+#include "loopTiming.h"
+#include "eventLog.h"
+#include "recorderSchema.h"
+
+// Accumulators and the last closed minute, persisted by MetricsLog across resets
+struct metricsState
+{
+    uint32_t sampleCount, skippedCount;              // Divisors of the averages
+    float energySum, visibilityError, flickerSum;    // Metrics accumulators
+    historyEntry minute;                             // Last closed minute aggregate
+    int minuteStart;                                 // Start of that minute (ms since boot)
+};
 
 class dataStorageMetrics {
 public:
+    static constexpr float LED_MAX_POWER = 0.099f; // Maximum power consumption in Watts Pmax = V_F × I_F = 3,3V × 30mA = 99mW
+
+    // Extra signals recorded every control tick, channels declared in recorderSchema
+    typedef SignalRecorder<recorderSchema> Recorder;
+
     // Constructor
     explicit dataStorageMetrics();
 
@@ -16,14 +38,70 @@ public:
     // Insert new values into the circular buffers
     void insertValues(float dutyCycle, float luxMeasured, float luxReference, int timestamp);
 
-    // Get buffer contents (returns number of valid elements)
-    uint16_t getBuffer(float* dutyCycleOut, float* luxOut, int* timestampsOut);
+    // Account for a control tick skipped by the event trigger (duty cycle held)
+    void insertSkipped(float luxMeasured, float luxReference);
+
+    // Get number of skipped control ticks
+    uint32_t getSkippedCount();
+
+    // Log the current value of a controller setting, recorded only when it changed
+    void logEvent(EventType type, float value, int timestamp);
+
+    // Get the log of reference and mode changes
+    const EventLog &getEventLog();
+
+    // Get the multi-signal recorder (fed by the control loop with Recorder::record)
+    Recorder &getRecorder();
+
+    // Get the streaming performance monitor (IAE/ISE/ITAE, saturation, oscillation)
+    PerformanceMonitor &getPerformanceMonitor();
+
+    // Account for the execution time of one control loop iteration (in microseconds)
+    void insertLoopTime(uint32_t elapsed);
+
+    // Get the streaming quantiles of the absolute tracking error (LUX, every tick)
+    QuantileSketch &getErrorQuantiles();
+
+    // Get the streaming quantiles of the loop execution time (microseconds)
+    QuantileSketch &getLoopTimeQuantiles();
+
+    // Get the period and execution-time statistics of the 500 Hz sampling step
+    LoopTiming &getSampleTiming();
+
+    // Get the period and execution-time statistics of the 100 Hz control step
+    LoopTiming &getControlTiming();
+
+    // Get number of samples held in the history
+    uint16_t getCount();
+
+    // Get a zero-copy view of the full-rate history (two block spans and a forward cursor)
+    CompressedHistory::View getHistoryView();
 
-    // Get u (duty cycle) buffer contents (returns number of valid elements)
-    uint16_t getUbuffer(float* uOut);
+    // Get a reader over the samples with t0 <= timestamp <= t1 (ms), one out of every k
+    CompressedHistory::Cursor getHistoryRange(int t0, int t1, uint16_t k = 1);
 
-    // Get y (lux) buffer contents (returns number of valid elements)
-    uint16_t getYbuffer(float* yOut);
+    // Get number of aggregates held in a downsampled tier (1: 1 Hz, 2: 1 per minute)
+    uint16_t getTierCount(uint8_t tier);
+
+    // Get window length of a downsampled tier in milliseconds (0 for an invalid tier)
+    uint32_t getTierPeriod(uint8_t tier);
+
+    // Get up to maxCount aggregates of a tier starting at the first-th oldest, with the start
+    // time of the first one (returns number copied)
+    uint16_t getTier(uint8_t tier, historyEntry* out, uint16_t first, uint16_t maxCount, int* firstTimestamp);
+
+    // Duty cycle and lux of a fixed-point aggregate
+    static float unpackDuty(uint16_t value);
+    static float unpackLux(uint16_t value);
+
+    // Copy the accumulators and the last closed minute
+    void getState(metricsState &state);
+
+    // Restore the accumulators (the history buffers start empty)
+    void setState(const metricsState &state);
+
+    // Returns true once after every closed minute of the minute tier
+    bool consumeMinuteClosed();
 
     // Get power consumption (in Watts)
     float getPowerConsumption();
@@ -37,28 +115,79 @@ public:
     // Calculate average flicker (in s^-1)
     float getFlicker();
 
+    // Sliding-window versions over the last few seconds (window 0: short, 1: long)
+    // Get window length in milliseconds (0 for an invalid window)
+    uint32_t getWindowLength(uint8_t window);
+
+    // Energy consumed in the window (in Joules)
+    float getWindowEnergy(uint8_t window);
+
+    // Average visibility error in the window (in LUX)
+    float getWindowVisibilityError(uint8_t window);
+
+    // Average flicker in the window (in s^-1)
+    float getWindowFlicker(uint8_t window);
+
+    // Metrics between t0 and t1 (ms), rounded inwards to the 1 s checkpoints of the index
+    // (energy in Joules); returns false if the range is not covered
+    bool getRangeMetrics(int t0, int t1, rangeMetrics &out);
+
 private:
-    static const uint16_t STORAGE_BUFFER_SIZE = 6000; // 100 Hz * 60 seconds = 6000 samples
     static const uint16_t SAMPLING_FREQ = 100; // 100 Hz
-    static constexpr float LED_MAX_POWER = 0.099f; // Maximum power consumption in Watts Pmax = V_F × I_F = 3,3V × 30mA = 99mW
+    static const uint32_t SAMPLE_PERIOD_US = 2000; // 500 Hz luxmeter sampling
     
-    // Circular buffers for u (duty cycle) and y (lux values)
-    float uBuffer[STORAGE_BUFFER_SIZE];  // Duty cycle values (0 to 1)
-    float yBuffer[STORAGE_BUFFER_SIZE];  // Measured lux values
-    float rBuffer[STORAGE_BUFFER_SIZE];  // Reference lux values
-    int timestampBuffer[STORAGE_BUFFER_SIZE]; // Timestamps in milliseconds
-    
-    uint16_t head;  // Points to next insertion position
-    uint16_t count; // Number of valid elements in buffer
-    bool isFull;    // Indicates if buffer is full
+    // Full-rate history: duty cycle and lux in 16-bit fixed point, compressed in fixed-size
+    // blocks (the number of samples held depends on how much the signals move)
+    // - duty cycle as 16-bit fixed point (1/65535)
+    // - lux as 16-bit fixed point (1/100 LUX, up to 655 LUX)
+    // - reference only on change, in the event log
+    static constexpr float DUTY_SCALE = 65535.0f;
+    static constexpr float LUX_SCALE = 100.0f;
+
+    CompressedHistory history;
+
+    EventLog events;            // Reference and mode changes
+    Recorder recorder;          // Schema-driven extra signals
+    uint32_t storedCount;       // Samples stored since boot
+
+    uint32_t sampleCount;  // Control ticks since boot (stored and skipped), divisor of the averages
+    uint32_t skippedCount; // Control ticks skipped by the event trigger
     
+    // Downsampled history tiers, each aggregating the one below (min/mean/max), powers of two
+    static const uint16_t SECOND_TIER_SIZE = 256; // 1 Hz, 4 minutes
+    static const uint16_t MINUTE_TIER_SIZE = 512; // 1 per minute, 8.5 hours (as the flash metrics log)
+    HistoryTier<SECOND_TIER_SIZE> secondTier;
+    HistoryTier<MINUTE_TIER_SIZE> minuteTier;
+    bool minuteClosed; // Set when a minute closes, consumed by the flash log
+
+    // Streaming control-performance figures, updated on every tick
+    PerformanceMonitor performance;
+    QuantileSketch errorQuantiles;
+    QuantileSketch loopTimeQuantiles;
+    LoopTiming sampleTiming;
+    LoopTiming controlTiming;
+    float lastDutyCycle; // Last stored duty cycle, also held during skipped ticks
+    int lastTimestamp;   // Timestamp of the last stored sample (ms)
+    float prevDutyCycle; // Duty cycle of the sample before the last one (flicker)
+
     // Metrics accumulators
     float energySum;        // For energy calculation
     float visibilityError;  // For visibility error calculation
     float flickerSum;      // For flicker calculation
 
-    // Helper method to increment circular buffer index
-    uint16_t incrementIndex(uint16_t idx);
+    // Sliding-window metrics
+    static const uint16_t SHORT_WINDOW_BUCKETS = 100; // 10 s of 100 ms buckets
+    static const uint16_t LONG_WINDOW_BUCKETS = 240;  // 60 s of 250 ms buckets
+    SlidingMetrics<SHORT_WINDOW_BUCKETS, 10> shortWindow;
+    SlidingMetrics<LONG_WINDOW_BUCKETS, 25> longWindow;
+
+    // Prefix sums of the metrics with a checkpoint per second, for time-range queries
+    static const uint16_t INDEX_SIZE = 256; // 4 minutes, as the 1 Hz tier
+    MetricsIndex<INDEX_SIZE> metricsIndex;
+
+    // Quantisation helpers
+    static uint16_t packDuty(float dutyCycle);
+    static uint16_t packLux(float lux);
 
     // Update metrics incrementally with each new sample
     void updateMetrics(float dutyCycle, float luxMeasured, float luxReference, int timestamp);
@@ -0,0 +1,71 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stdint.h>
+#include "ring.h"
+
+// Kinds of logged state changes (the letter is the serial command that sets it)
+enum EventType : uint8_t
+{
+    EVENT_REFERENCE,    // r, reference in LUX
+    EVENT_OCCUPANCY,    // o
+    EVENT_FEEDBACK,     // f
+    EVENT_ANTI_WINDUP,  // a
+    EVENT_MANUAL,       // u, manual duty cycle mode
+    EVENT_STRATEGY,     // c
+    EVENT_MPC,          // m
+    EVENT_TRAJECTORY,   // j
+    EVENT_NEIGHBOUR_FF, // n, neighbour feedforward
+    EVENT_TRIGGERED,    // w, event-triggered control
+    EVENT_CASCADE,      // k
+    EVENT_SMITH,        // x, Smith predictor
+    EVENT_TYPE_COUNT
+};
+
+struct eventRecord
+{
+    int timestamp; // ms
+    float value;
+    EventType type;
+};
+
+// EventLog class definition
+// Append-only ring of (timestamp, type, value) records, written only when the value of a
+// type changes. The newest value and time of every type are kept apart, so change
+// queries keep working after the ring wrapped.
+// methods :
+// - record: log the current value of a type, appends only on change (returns true if so)
+// - getCount / get: query, index 0 is the oldest record
+// - getLastChange: time of the newest change of a type
+class EventLog
+{
+public:
+    static const uint8_t CAPACITY = 64;
+
+    // Constructor
+    EventLog();
+
+    // Log the current value of a type, appended only if it changed
+    bool record(EventType type, float value, int timestamp);
+
+    // Get number of records held
+    uint8_t getCount() const;
+
+    // Get record i, 0 is the oldest
+    const eventRecord &get(uint8_t i) const;
+
+    // Get the time of the newest change of a type (false if it never changed)
+    bool getLastChange(EventType type, int &timestamp) const;
+
+    // Get the letter of a type
+    static char getLetter(EventType type);
+
+private:
+    Ring<eventRecord, CAPACITY> _records;
+
+    bool _seen[EVENT_TYPE_COUNT];
+    float _lastValue[EVENT_TYPE_COUNT];
+    int _lastTime[EVENT_TYPE_COUNT];
+};
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef FLASH_RING_H
+#define FLASH_RING_H
+
+#include <Arduino.h>
+#include "hardware/flash.h"
+
+// FlashRing class definition
+// Log of CRC-protected records in a ring of flash sectors, the storage behind the controller
+// snapshots and the metrics log. Every record takes one 64-byte slot (magic, sequence,
+// payload, CRC); a torn record fails its CRC and is skipped, so power loss costs at most the
+// record being written.
+// append only stages the record in RAM, the flash itself is written by a FlashScheduler
+// outside the control step. The sector after the head is erased ahead of time, so a staged
+// record only waits for an erase if the ring fills a sector before an idle window came.
+// The erase state lives in RAM: the head slot is always erased, and the sector ahead is
+// scanned at most once per sector the head enters (an erase marks it directly).
+// Arguments:
+// - flashOffset: offset of the first sector from the start of flash (sector aligned)
+// - sectorCount: sectors in the ring (at least 3, the sector ahead never holds the newest record)
+// - magic: tag of the record type
+// methods :
+// - begin: locate the newest record and the head (first slot of every sector, then one sector)
+// - getNewest: payload of the newest valid record (nullptr if none)
+// - append: stage a record for the scheduler, replacing one still staged
+// - getRecord: payload of the n-th slot counting from the oldest sector (nullptr if erased or invalid)
+class FlashRing
+{
+public:
+    static const uint32_t SLOT_SIZE = 64;
+    static const uint32_t PAYLOAD_SIZE = SLOT_SIZE - 3 * sizeof(uint32_t);
+    static const uint32_t SLOTS_PER_SECTOR = FLASH_SECTOR_SIZE / SLOT_SIZE;
+
+    // Constructor
+    FlashRing(uint32_t flashOffset, uint32_t sectorCount, uint32_t magic);
+
+    // Scan the flash region at boot (erases the head sector if it is not ready)
+    void begin();
+
+    // Get the payload of the newest valid record
+    const uint8_t *getNewest() const;
+
+    // Stage a record of length bytes (at most PAYLOAD_SIZE), written by the scheduler
+    void append(const void *payload, size_t length);
+
+    // Get the payload and sequence number of the n-th slot from the oldest sector
+    const uint8_t *getRecord(uint32_t n, uint32_t &sequence) const;
+
+    // Get slot of the newest valid record and of the head (-1 if none)
+    int32_t getNewestSlot() const { return _newest; }
+    uint32_t getHeadSlot() const { return _head; }
+
+    // Get number of slots in the ring
+    uint32_t getSlotCount() const { return _slotCount; }
+
+private:
+    friend class FlashScheduler;
+
+    static const uint32_t SLOTS_PER_PAGE = FLASH_PAGE_SIZE / SLOT_SIZE;
+
+    enum sectorState : uint8_t
+    {
+        SECTOR_UNKNOWN,
+        SECTOR_ERASED,
+        SECTOR_DIRTY,
+    };
+
+    struct record
+    {
+        uint32_t magic;
+        uint32_t sequence;
+        uint8_t payload[PAYLOAD_SIZE];
+        uint32_t crc;
+    };
+    static_assert(sizeof(record) == SLOT_SIZE, "record must fill a slot");
+
+    uint32_t _flashOffset;
+    uint32_t _sectorCount, _slotCount;
+    uint32_t _magic;
+    uint32_t _head;      // Next slot to program, always erased
+    uint32_t _sequence;  // Sequence number of the next record
+    int32_t _newest;     // Slot of the newest valid record (-1 if none)
+    sectorState _ahead;  // Erase state of the sector after the head sector
+    bool _staged;        // _record waits for the scheduler
+    record _record;      // Staged record (sequence and CRC set when programmed)
+
+    // Scheduler steps
+    // A record is staged and the head can take it (mid-sector, or the sector ahead is erased)
+    bool canProgram() const;
+    void program();
+    // The sector ahead must be erased before the head reaches it (scans it once if unknown)
+    bool needsErase();
+    void eraseAhead();
+
+    uint32_t aheadSector() const { return (_head / SLOTS_PER_SECTOR + 1) % _sectorCount; }
+    const record *slotAddress(uint32_t slot) const;
+    bool slotIsValid(uint32_t slot) const;
+    bool slotIsErased(uint32_t slot) const;
+    bool sectorIsErased(uint32_t sector) const;
+    void eraseSector(uint32_t sector);
+
+    static uint32_t crc32(const uint8_t *data, size_t length);
+};
+
+// FlashScheduler class definition
+// Runs the flash operations of the FlashRings outside the control step, one per call.
+// The flash cannot be read while it is programmed or erased, so everything executing from
+// it stalls meanwhile: a page program (well below 1 ms) only starts when it fits in the
+// slack the caller has before its next deadline, a sector erase (tens of ms, longer than any
+// slack) only in an idle window, when the caller reports the loop at steady state.
+// The program budget is a running average of the measured programs.
+// An erase still stalls the loop with interrupts off: about 45 ms for a 4 KB sector (up to a
+// few hundred ms worst case on the QSPI part), so 4 to 5 control ticks and their samples are
+// late. It happens once per sector the head enters, at most every SLOTS_PER_SECTOR records.
+// methods :
+// - add: register a ring (up to MAX_RINGS, served round-robin)
+// - service: call from loop() with the slack to the next deadline (us) and the idle flag;
+//   returns true if flash was touched
+class FlashScheduler
+{
+public:
+    // Constructor
+    FlashScheduler();
+
+    // Register a ring (returns false if full)
+    bool add(FlashRing &ring);
+
+    // Run at most one program (if it fits in slack) or one erase (if idle)
+    bool service(uint32_t slack, bool idle);
+
+    // Get the average page program time (us)
+    uint32_t getProgramTime() const { return _programTime; }
+
+private:
+    static const uint8_t MAX_RINGS = 4;
+    static const uint32_t PROGRAM_TIME = 1000; // Program budget before the first measurement (us)
+
+    FlashRing *_rings[MAX_RINGS];
+    uint8_t _ringCount;
+    uint8_t _next;          // Ring served first in the next call
+    uint32_t _programTime;  // Running average of the page programs (us)
+};
+
+#endif
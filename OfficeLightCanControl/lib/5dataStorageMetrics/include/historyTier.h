@@ -0,0 +1,127 @@
+#ifndef HISTORY_TIER_H
+#define HISTORY_TIER_H
+
+#include <stdint.h>
+#include "ring.h"
+
+// Aggregate of one history window, fixed point like the raw samples
+// (duty cycle in 1/65535, lux in 1/100 LUX). An empty window has min > max.
+struct historyEntry
+{
+    uint16_t uMin, uMean, uMax;
+    uint16_t yMin, yMean, yMax;
+
+    bool isEmpty() const { return uMin > uMax; }
+};
+
+// HistoryTier class definition
+// Ring of CAPACITY (a power of two) min/mean/max aggregates over fixed time windows of periodMs.
+// Fed with samples (or the closed entries of a finer tier) in time order, O(1) per add.
+// Windows are aligned to multiples of periodMs; windows without data are stored empty.
+// methods :
+// - add: fold an entry into the open window, returns true if a non-empty window closed
+// - getLastClosed / getLastClosedStart: the window that just closed (to feed the next tier)
+// - getCount / getEntry / getStart: query, index 0 is the oldest entry
+template <uint16_t CAPACITY>
+class HistoryTier
+{
+public:
+    explicit HistoryTier(uint32_t periodMs)
+        : _period(periodMs), _started(false), _windowStart(0), _lastClosedStart(0)
+    {
+        _lastClosed = {1, 0, 0, 1, 0, 0};
+        resetWindow();
+    }
+
+    bool add(int timestamp, const historyEntry &e)
+    {
+        if (!_started)
+        {
+            _windowStart = timestamp - (int)((uint32_t)timestamp % _period);
+            _started = true;
+        }
+
+        bool closed = false;
+        if (timestamp >= _windowStart + (int)_period)
+        {
+            closed = _n > 0;
+            _lastClosedStart = _windowStart;
+            _lastClosed = closeWindow();
+            push(_lastClosed);
+            _windowStart += _period;
+
+            // Windows without data (loop stalls), at most one full ring is written
+            uint32_t missed = (uint32_t)(timestamp - _windowStart) / _period;
+            historyEntry empty = {1, 0, 0, 1, 0, 0};
+            for (uint32_t i = 0; i < missed && i < CAPACITY; i++)
+            {
+                push(empty);
+            }
+            _windowStart += missed * _period;
+        }
+
+        if (e.uMin < _acc.uMin) _acc.uMin = e.uMin;
+        if (e.uMax > _acc.uMax) _acc.uMax = e.uMax;
+        if (e.yMin < _acc.yMin) _acc.yMin = e.yMin;
+        if (e.yMax > _acc.yMax) _acc.yMax = e.yMax;
+        _uSum += e.uMean;
+        _ySum += e.yMean;
+        _n++;
+        return closed;
+    }
+
+    const historyEntry &getLastClosed() const { return _lastClosed; }
+    int getLastClosedStart() const { return _lastClosedStart; }
+
+    uint16_t getCount() const { return _entries.size(); }
+    uint32_t getPeriod() const { return _period; }
+
+    // Entry i, 0 is the oldest
+    const historyEntry &getEntry(uint16_t i) const
+    {
+        return _entries[i];
+    }
+
+    // Start time (ms) of entry i
+    int getStart(uint16_t i) const
+    {
+        return _windowStart - (int)((uint32_t)(_entries.size() - i) * _period);
+    }
+
+private:
+    Ring<historyEntry, CAPACITY> _entries;
+    uint32_t _period;
+    bool _started;
+    int _windowStart, _lastClosedStart;
+    historyEntry _lastClosed;
+
+    // Open window accumulators
+    historyEntry _acc;
+    uint32_t _uSum, _ySum, _n;
+
+    void resetWindow()
+    {
+        _acc = {0xFFFF, 0, 0, 0xFFFF, 0, 0};
+        _uSum = _ySum = _n = 0;
+    }
+
+    historyEntry closeWindow()
+    {
+        historyEntry e = {1, 0, 0, 1, 0, 0};
+        if (_n > 0)
+        {
+            e = _acc;
+            e.uMean = (uint16_t)((_uSum + _n / 2) / _n);
+            e.yMean = (uint16_t)((_ySum + _n / 2) / _n);
+        }
+        resetWindow();
+        return e;
+    }
+
+    void push(const historyEntry &e)
+    {
+        _entries.pushOverwrite(e);
+    }
+};
+
+#endif
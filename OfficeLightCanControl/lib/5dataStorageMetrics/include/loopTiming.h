@@ -0,0 +1,70 @@
+#ifndef LOOP_TIMING_H
+#define LOOP_TIMING_H
+
+#include <stdint.h>
+
+// LoopTiming class definition
+// Period and execution-time statistics of a periodic loop step, in microseconds.
+// Both are kept in log-bucketed histograms (SUB_BINS bins per octave, O(1) per step),
+// with the worst period and the worst execution time and when they happened.
+// A step misses its deadline when it ends after the start of the next period, i.e. its
+// lateness (measured period - target period) plus its execution time exceeds the target.
+// Arguments:
+// - periodUs: target period in microseconds
+// methods :
+// - start: call at the start of every step (micros and millis)
+// - stop: call at the end of the step, returns the execution time
+// - getters for the counters, the worst offenders and the histogram bins
+// - getBinLower: lower bound (us) of histogram bin i
+class LoopTiming
+{
+public:
+    static const uint8_t SUB_BITS = 2;
+    static const uint8_t SUB_BINS = 1 << SUB_BITS;   // 4 bins per octave (at most 19 % wide)
+    static const uint8_t BIN_COUNT = 23 * SUB_BINS;  // Last bin from 14.7 s
+
+    // Constructor
+    explicit LoopTiming(uint32_t periodUs);
+
+    // Start of a step
+    void start(uint32_t nowUs, unsigned long nowMs);
+
+    // End of a step, returns the execution time in microseconds
+    uint32_t stop(uint32_t nowUs);
+
+    // Clear all counters
+    void reset();
+
+    uint32_t getTargetPeriod() const { return _target; }
+    uint32_t getSteps() const { return _steps; }
+    uint32_t getMisses() const { return _misses; }
+    uint32_t getMeanPeriod() const { return _periods ? (uint32_t)(_periodSum / _periods) : 0; }
+    uint32_t getWorstPeriod() const { return _worstPeriod; }
+    unsigned long getWorstPeriodTime() const { return _worstPeriodTime; }
+    uint32_t getWorstExecution() const { return _worstExecution; }
+    unsigned long getWorstExecutionTime() const { return _worstExecutionTime; }
+    uint32_t getPeriodBin(uint8_t i) const { return _periodBins[i]; }
+    uint32_t getExecutionBin(uint8_t i) const { return _executionBins[i]; }
+
+    // Lower bound of bin i in microseconds
+    static uint32_t getBinLower(uint8_t i);
+
+private:
+    uint32_t _target;
+    uint32_t _lastStart;       // micros() of the current step
+    unsigned long _startMs;    // millis() of the current step
+    uint32_t _lateness;        // Lateness of the current step
+    bool _started;
+
+    uint32_t _steps, _periods, _misses;
+    uint64_t _periodSum;
+    uint32_t _worstPeriod, _worstExecution;
+    unsigned long _worstPeriodTime, _worstExecutionTime;
+
+    uint32_t _periodBins[BIN_COUNT];
+    uint32_t _executionBins[BIN_COUNT];
+
+    static uint8_t binIndex(uint32_t us);
+};
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef METRICS_INDEX_H
+#define METRICS_INDEX_H
+
+#include <stdint.h>
+#include "ring.h"
+
+// Metrics accumulated between two checkpoints of a MetricsIndex
+struct rangeMetrics
+{
+    int start, end;        // Checkpoint times actually covered (ms)
+    uint32_t ticks;        // Control ticks in the range
+    float energy;          // duty * s
+    float visibilityError; // Mean per tick (LUX)
+    float flicker;         // Mean per tick (duty)
+};
+
+// MetricsIndex class definition
+// Running prefix sums of the energy, visibility error and flicker contributions, with a
+// checkpoint (timestamp and the sums so far) at the first sample of every PERIOD_MS.
+// The metrics between two times are the difference of two checkpoints, found by binary
+// search on the checkpoint timestamps: O(log CAPACITY) for any range in the index.
+// Sums are unsigned fixed point and wrap around; differences stay exact as long as a
+// range sums below 2^32 (worst case over CAPACITY seconds, typical use far below).
+// methods :
+// - add: contributions of one control tick (stored or skipped)
+// - mark: call with the timestamp of every stored sample, before its add
+// - query: metrics between the checkpoints at or after t0 and at or before t1
+// CAPACITY must be a power of two (Ring).
+template <uint32_t CAPACITY>
+class MetricsIndex
+{
+public:
+    static const uint32_t PERIOD_MS = 1000; // Checkpoint resolution
+
+    MetricsIndex() : _lastTime(0), _started(false)
+    {
+        _sums = {0, 0, 0, 0, 0};
+    }
+
+    void add(float energy, float visibility, float flicker)
+    {
+        _sums.energy += toFixed(energy * ENERGY_SCALE);
+        _sums.visibility += toFixed(visibility * VISIBILITY_SCALE);
+        _sums.flicker += toFixed(flicker * FLICKER_SCALE);
+        _sums.ticks++;
+    }
+
+    void mark(int timestamp)
+    {
+        if (!_started || (uint32_t)timestamp / PERIOD_MS != (uint32_t)_lastTime / PERIOD_MS)
+        {
+            _sums.time = timestamp;
+            _entries.pushOverwrite(_sums);
+            _started = true;
+        }
+        _lastTime = timestamp;
+    }
+
+    // Returns false if the range holds less than two checkpoints
+    bool query(int t0, int t1, rangeMetrics &out) const
+    {
+        uint32_t count = _entries.size();
+        if (count == 0 || t1 <= t0)
+        {
+            return false;
+        }
+
+        // The running sums act as a last checkpoint at the newest sample
+        checkpoint now = _sums;
+        now.time = _lastTime;
+
+        uint32_t first = lowerBound(t0);
+        if (first == count)
+        {
+            return false;
+        }
+        const checkpoint &a = _entries[first];
+
+        uint32_t last = lowerBound(t1 + 1); // First checkpoint after t1
+        if (last == 0)
+        {
+            return false;
+        }
+        const checkpoint &b = (last == count && _lastTime <= t1) ? now : _entries[last - 1];
+        if (b.time <= a.time)
+        {
+            return false;
+        }
+
+        out.start = a.time;
+        out.end = b.time;
+        out.ticks = b.ticks - a.ticks;
+        out.energy = (uint32_t)(b.energy - a.energy) / ENERGY_SCALE;
+        out.visibilityError = out.ticks ? (uint32_t)(b.visibility - a.visibility) / VISIBILITY_SCALE / out.ticks : 0.0f;
+        out.flicker = out.ticks ? (uint32_t)(b.flicker - a.flicker) / FLICKER_SCALE / out.ticks : 0.0f;
+        return true;
+    }
+
+private:
+    static constexpr float ENERGY_SCALE = 1e5f;     // 1e-5 duty * s
+    static constexpr float VISIBILITY_SCALE = 1e2f; // 1/100 LUX
+    static constexpr float FLICKER_SCALE = 1e4f;    // 1e-4 duty
+
+    struct checkpoint
+    {
+        int time;
+        uint32_t ticks;
+        uint32_t energy, visibility, flicker;
+    };
+
+    Ring<checkpoint, CAPACITY> _entries;
+    checkpoint _sums; // Running sums
+    int _lastTime;
+    bool _started;
+
+    // Index of the first checkpoint at or after t (size if none)
+    uint32_t lowerBound(int t) const
+    {
+        uint32_t lo = 0, hi = _entries.size();
+        while (lo < hi)
+        {
+            uint32_t mid = (lo + hi) / 2;
+            if (_entries[mid].time < t)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    static uint32_t toFixed(float value) { return (uint32_t)(int32_t)(value >= 0.0f ? value + 0.5f : value - 0.5f); }
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef METRICS_LOG_H
+#define METRICS_LOG_H
+
+#include <Arduino.h>
+#include "hardware/flash.h"
+#include "dataStorageMetrics.h"
+#include "flashRing.h"
+
+// MetricsLog class definition
+// Log-structured copy of the dataStorageMetrics accumulators in a ring of flash sectors.
+// One CRC-protected record is appended per closed minute (accumulators and the minute
+// min/mean/max), so a reset keeps the energy, visibility error and flicker and the flash
+// holds the last SECTOR_COUNT * RECORDS_PER_SECTOR minutes of history.
+// service only stages the record after the control step, the FlashRing writes it later from
+// the FlashScheduler (page program in the loop slack, sector erases ahead at steady state).
+// Arguments:
+// - flashOffset: offset of the first sector from the start of flash (sector aligned)
+// methods :
+// - begin: locate the newest record and the head (first slot of every sector, then one sector)
+// - restore: load the newest accumulators into dataStorageMetrics (returns false if none)
+// - service: call after each control step, stages a record on every closed minute
+// - getRecord: read the n-th slot counting from the oldest sector
+// - getRing: flash ring of the records, for the scheduler
+class MetricsLog
+{
+public:
+    // Constructor
+    explicit MetricsLog(uint32_t flashOffset);
+
+    // Scan the flash region at boot
+    void begin();
+
+    // Restore the newest accumulators into the metrics
+    bool restore(dataStorageMetrics &metrics);
+
+    // Stage a record on every closed minute; returns true if one was staged
+    bool service(dataStorageMetrics &metrics);
+
+    // Read the n-th slot in ring order from the oldest sector (false if erased or invalid)
+    bool getRecord(uint32_t n, metricsState &state, uint32_t &sequence) const;
+
+    // Get the flash ring holding the records
+    FlashRing &getRing();
+
+    static const uint32_t SECTOR_COUNT = 8;                               // Sectors in the ring
+    static const uint32_t REGION_SIZE = SECTOR_COUNT * FLASH_SECTOR_SIZE; // Bytes of flash used
+    static const uint32_t RECORDS_PER_SECTOR = FlashRing::SLOTS_PER_SECTOR;
+    static const uint32_t SLOT_COUNT = SECTOR_COUNT * RECORDS_PER_SECTOR;
+
+private:
+    static const uint32_t MAGIC = 0x4D4C434F; // "OCLM"
+    static_assert(sizeof(metricsState) <= FlashRing::PAYLOAD_SIZE, "metrics record does not fit in a slot");
+
+    FlashRing _ring;
+};
+
+#endif
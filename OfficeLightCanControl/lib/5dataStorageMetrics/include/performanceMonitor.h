@@ -0,0 +1,53 @@
+#ifndef PERFORMANCE_MONITOR_H
+#define PERFORMANCE_MONITOR_H
+
+#include <stdint.h>
+#include <math.h>
+
+// PerformanceMonitor class definition
+// Streaming control-performance figures over an exponential window (no sample storage).
+// Fed once per control tick with the reference, measurement and duty cycle.
+// Arguments:
+// - h: control period in seconds
+// - window: time constant of the exponential window in seconds
+// methods :
+// - update: add one tick
+// - getIAE / getISE / getITAE: windowed integral of |e|, e^2 and t*|e| (t since the last reference change)
+// - getSaturation: fraction of the window spent with the duty cycle at 0 or 1
+// - getOscillation: zero crossings of the error per second (with hysteresis)
+// - pack / unpack: 8-byte CAN payload
+class PerformanceMonitor
+{
+public:
+    // Constructor
+    PerformanceMonitor(float h = 0.01f, float window = 10.0f);
+
+    // Add one control tick
+    void update(float r, float y, float u);
+
+    float getIAE();         // LUX*s
+    float getISE();         // LUX^2*s
+    float getITAE();        // LUX*s^2
+    float getSaturation();  // 0 to 1
+    float getOscillation(); // Crossings per second
+
+    // Pack the figures into 8 bytes (fixed point, saturating)
+    void pack(uint8_t *data);
+
+    // Unpack 8 bytes into iae, ise, itae, saturation and oscillation
+    static void unpack(const uint8_t *data, float *values);
+
+private:
+    static constexpr float CROSSING_BAND = 0.1f; // Hysteresis of the zero-crossing detector (LUX)
+
+    float _h, _window;
+    float _lambda;           // Per-tick decay exp(-h / window)
+    float _iae, _ise, _itae;
+    float _saturation;
+    float _crossings;        // Windowed crossing count
+    float _lastR;            // Reference of the previous tick
+    float _tStep;            // Time since the last reference change (s)
+    int8_t _errorSign;       // Sign of the error outside the hysteresis band
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+#include <stdint.h>
+
+// QuantileSketch class definition
+// Fixed-memory streaming quantiles of a positive quantity (log-bucketed histogram).
+// Each octave from 2^MIN_EXPONENT to 2^MAX_EXPONENT is split in SUB_BINS bins, the bin
+// index is read straight from the float exponent and mantissa bits (no log), so add is
+// O(1) and a quantile is within 1/(2*SUB_BINS) (about 3 %) of the true value.
+// Values below the range count as 0, values above it land in the last bin.
+// The counts are halved every HALVING_COUNT samples, so old samples fade out
+// (at 100 Hz the quantiles follow roughly the last 10 to 20 minutes).
+// methods :
+// - add: one sample
+// - getQuantile: value at quantile q (0 to 1)
+// - getCount: samples currently weighted
+// - reset: clear all bins
+class QuantileSketch
+{
+public:
+    // Constructor
+    QuantileSketch();
+
+    // Add one sample
+    void add(float value);
+
+    // Get the value at quantile q (0 if empty)
+    float getQuantile(float q) const;
+
+    // Get number of samples currently weighted
+    uint32_t getCount() const;
+
+    // Clear all bins
+    void reset();
+
+private:
+    static const int MIN_EXPONENT = -7;                 // 0.0078
+    static const int MAX_EXPONENT = 17;                 // 131072
+    static const uint8_t SUB_BITS = 4;
+    static const uint16_t SUB_BINS = 1 << SUB_BITS;     // Bins per octave
+    static const uint16_t BIN_COUNT = (MAX_EXPONENT - MIN_EXPONENT) * SUB_BINS + 1; // Bin 0 below the range
+    static const uint32_t HALVING_COUNT = 60000;        // 10 minutes at 100 Hz
+
+    uint16_t _bins[BIN_COUNT];
+    uint32_t _count;
+
+    static uint16_t binIndex(float value);
+    static float binValue(uint16_t bin);
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef RECORDER_SCHEMA_H
+#define RECORDER_SCHEMA_H
+
+#include "signalRecorder.h"
+
+// Channels of the signal recorder, in schema order (the read callback of record switches on these)
+enum RecorderChannel
+{
+    REC_DUTY,
+    REC_LUX,
+    REC_REFERENCE,
+    REC_LDR_VOLTAGE,
+    REC_EXTERNAL,
+    REC_INTEGRATOR,
+    REC_NEIGHBOUR_0,
+    REC_NEIGHBOUR_1,
+    REC_NEIGHBOUR_2,
+    REC_NEIGHBOUR_3,
+    REC_CHANNEL_COUNT
+};
+
+// Recorder schema, one record per control tick. To record a signal set its length; a
+// channel with length 0 costs no RAM and its value is never read.
+struct recorderSchema
+{
+    static const uint32_t PERIOD_MS = 10; // 100 Hz control tick
+
+    static constexpr channelSpec channels[REC_CHANNEL_COUNT] = {
+        // name, type, scale, decimation, length
+        {"u", CHANNEL_U16, 10000.0f, 1, 0},        // Duty cycle, already in CompressedHistory
+        {"y", CHANNEL_U16, 100.0f, 1, 0},          // LUX, already in CompressedHistory
+        {"r", CHANNEL_U16, 100.0f, 1, 0},          // LUX, changes already in the EventLog
+        {"v", CHANNEL_U16, 10000.0f, 1, 512},      // LDR voltage (V), 5 s
+        {"d", CHANNEL_I16, 100.0f, 8, 512},        // Estimated external illuminance (LUX), 41 s
+        {"I", CHANNEL_I16, 2.0f, 1, 512},          // Integral term (PWM counts), 5 s
+        {"n0", CHANNEL_U8, 250.0f, 4, 256},        // Neighbour duty cycles, 10 s
+        {"n1", CHANNEL_U8, 250.0f, 4, 256},
+        {"n2", CHANNEL_U8, 250.0f, 4, 256},
+        {"n3", CHANNEL_U8, 250.0f, 4, 256},
+    };
+};
+
+#endif
@@ -0,0 +1,225 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Smallest power of two holding n elements (capacity of a Ring sized for a window of n)
+constexpr uint32_t ringCapacity(uint32_t n, uint32_t capacity = 1)
+{
+    return capacity >= n ? capacity : ringCapacity(n, capacity * 2);
+}
+
+// Ring class definition
+// Fixed-capacity circular buffer of N elements, N a power of two.
+// Head and tail are free-running 32-bit counters and an element index is counter & (N - 1),
+// so no operation divides (the M0+ has no divide instruction) and full and empty differ
+// without a spare slot.
+// Single-threaded: use SpscRing to pass data between the two cores.
+// methods :
+// - push / pop: one element, false if full / empty
+// - pushOverwrite: push that evicts the oldest element when full (histories)
+// - pushBatch / popBatch: up to n elements with at most two copies each
+// - operator[] / back: element i from the oldest / the newest element
+// - getSpan: the content as at most two contiguous spans (before and after the wrap)
+template <typename T, uint32_t N>
+class Ring
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "Ring capacity must be a power of two");
+
+public:
+    static const uint32_t MASK = N - 1;
+
+    Ring() : _head(0), _tail(0) {}
+
+    bool push(const T &value)
+    {
+        if (full())
+            return false;
+        _data[_head++ & MASK] = value;
+        return true;
+    }
+
+    void pushOverwrite(const T &value)
+    {
+        if (full())
+            _tail++;
+        _data[_head++ & MASK] = value;
+    }
+
+    bool pop(T &value)
+    {
+        if (empty())
+            return false;
+        value = _data[_tail++ & MASK];
+        return true;
+    }
+
+    // Drop the n oldest elements
+    void discard(uint32_t n)
+    {
+        _tail += n < size() ? n : size();
+    }
+
+    uint32_t pushBatch(const T *values, uint32_t n)
+    {
+        uint32_t space = N - size();
+        if (n > space)
+            n = space;
+        copyIn(_data, _head, values, n);
+        _head += n;
+        return n;
+    }
+
+    uint32_t popBatch(T *values, uint32_t n)
+    {
+        if (n > size())
+            n = size();
+        copyOut(_data, _tail, values, n);
+        _tail += n;
+        return n;
+    }
+
+    // Element i, 0 is the oldest
+    T &operator[](uint32_t i) { return _data[(_tail + i) & MASK]; }
+    const T &operator[](uint32_t i) const { return _data[(_tail + i) & MASK]; }
+
+    T &back() { return _data[(_head - 1) & MASK]; }
+    const T &back() const { return _data[(_head - 1) & MASK]; }
+
+    // Span 0 starts at the oldest element, span 1 (after the wrap) may be empty
+    const T *getSpan(uint8_t i, uint32_t &length) const
+    {
+        return span(_data, _tail, size(), i, length);
+    }
+
+    uint32_t size() const { return _head - _tail; }
+    bool empty() const { return _head == _tail; }
+    bool full() const { return size() == N; }
+    void clear() { _tail = _head; }
+    static uint32_t capacity() { return N; }
+
+    // Shared with SpscRing
+    static void copyIn(T *data, uint32_t at, const T *values, uint32_t n)
+    {
+        for (uint32_t i = 0; i < n; i++)
+            data[(at + i) & MASK] = values[i];
+    }
+
+    static void copyOut(const T *data, uint32_t at, T *values, uint32_t n)
+    {
+        for (uint32_t i = 0; i < n; i++)
+            values[i] = data[(at + i) & MASK];
+    }
+
+    static const T *span(const T *data, uint32_t tail, uint32_t count, uint8_t i, uint32_t &length)
+    {
+        uint32_t start = tail & MASK;
+        uint32_t first = count < N - start ? count : N - start;
+        length = i == 0 ? first : count - first;
+        return i == 0 ? data + start : data;
+    }
+
+private:
+    T _data[N];
+    uint32_t _head, _tail;
+};
+
+// SpscRing class definition
+// Lock-free single-producer / single-consumer variant of Ring, safe across the two RP2040
+// cores. The producer only writes _head and the consumer only writes _tail; the element
+// writes are published with a release store of _head and the slot is handed back with a
+// release store of _tail (acquire loads on the other side), so no lock or interrupt
+// masking is needed. 32-bit atomics are lock-free on the M0+ (plain loads and stores
+// with memory barriers).
+// No firmware path uses it yet: everything runs on core 0, and the serial and CAN code poll
+// their peripherals without queues of their own. scripts/ringBench stress-tests it on the
+// host with two threads.
+// methods :
+// - producer: push / pushBatch / getFree
+// - consumer: pop / popBatch / getSpan + consume (zero-copy read) / size
+template <typename T, uint32_t N>
+class SpscRing
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "Ring capacity must be a power of two");
+
+public:
+    SpscRing() : _head(0), _tail(0) {}
+
+    // Producer side
+    bool push(const T &value)
+    {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == N)
+            return false;
+        _data[head & (N - 1)] = value;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t pushBatch(const T *values, uint32_t n)
+    {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        uint32_t space = N - (head - _tail.load(std::memory_order_acquire));
+        if (n > space)
+            n = space;
+        Ring<T, N>::copyIn(_data, head, values, n);
+        _head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    uint32_t getFree() const
+    {
+        return N - (_head.load(std::memory_order_relaxed) - _tail.load(std::memory_order_acquire));
+    }
+
+    // Consumer side
+    bool pop(T &value)
+    {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (_head.load(std::memory_order_acquire) == tail)
+            return false;
+        value = _data[tail & (N - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t popBatch(T *values, uint32_t n)
+    {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        uint32_t available = _head.load(std::memory_order_acquire) - tail;
+        if (n > available)
+            n = available;
+        Ring<T, N>::copyOut(_data, tail, values, n);
+        _tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    // Readable elements up to the wrap, released with consume (call again for the rest).
+    // One head load per call, so the span stays valid while the producer keeps pushing.
+    const T *getSpan(uint32_t &length) const
+    {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        uint32_t count = _head.load(std::memory_order_acquire) - tail;
+        return Ring<T, N>::span(_data, tail, count, 0, length);
+    }
+
+    void consume(uint32_t n)
+    {
+        _tail.store(_tail.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    uint32_t size() const
+    {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_relaxed);
+    }
+
+    static uint32_t capacity() { return N; }
+
+private:
+    T _data[N];
+    std::atomic<uint32_t> _head; // Written by the producer only
+    std::atomic<uint32_t> _tail; // Written by the consumer only
+};
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef SIGNAL_RECORDER_H
+#define SIGNAL_RECORDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <utility>
+
+// Storage type of a recorder channel
+enum ChannelType
+{
+    CHANNEL_U8,
+    CHANNEL_U16,
+    CHANNEL_I16,
+};
+
+// One channel of a recorder schema: the value is stored as round(value * scale) in type
+// (clamped), one sample every decimation ticks, the last length samples kept.
+// decimation and length are powers of two; length 0 disables the channel.
+struct channelSpec
+{
+    const char *name;
+    ChannelType type;
+    float scale;
+    uint8_t decimation;
+    uint16_t length;
+};
+
+// Bytes of a channel in the pool, padded so every channel starts 2-byte aligned
+constexpr size_t channelBytes(const channelSpec &spec)
+{
+    return (spec.length * (spec.type == CHANNEL_U8 ? 1 : 2) + 1) & ~(size_t)1;
+}
+
+// Start of channel c in the sample pool of a recorder schema (c = channel count gives the size)
+template <typename SCHEMA>
+constexpr size_t channelOffset(size_t c)
+{
+    size_t bytes = 0;
+    for (size_t k = 0; k < c; k++)
+    {
+        bytes += channelBytes(SCHEMA::channels[k]);
+    }
+    return bytes;
+}
+
+// SignalRecorder class definition
+// Ring of samples per channel for the channels declared in SCHEMA, a type with
+// static constexpr channelSpec channels[] and static const uint32_t PERIOD_MS (record period).
+// Storage is one byte pool laid out channel after channel, offsets fixed at compile time,
+// and all channels share a single tick counter (no per-channel head or count).
+// record is expanded per channel at compile time: a disabled channel has no storage and no
+// code, and the read callback is only called for the channels due in the tick, so a value
+// that is not recorded is never computed.
+// methods :
+// - record: one tick, read(channel) returns the value of the channel (called once per due channel)
+// - findChannel / getChannel: schema lookup for the exporters
+// - getCount / getSample / getSampleTime: samples held by a channel, 0 is the oldest
+template <typename SCHEMA>
+class SignalRecorder
+{
+public:
+    static constexpr size_t CHANNEL_COUNT = sizeof(SCHEMA::channels) / sizeof(channelSpec);
+    static constexpr size_t STORAGE_SIZE = channelOffset<SCHEMA>(CHANNEL_COUNT);
+
+    SignalRecorder() : _ticks(0), _lastTime(0) {}
+
+    template <typename Read>
+    void record(int timestamp, Read read)
+    {
+        recordChannels(read, std::make_index_sequence<CHANNEL_COUNT>());
+        _ticks++;
+        _lastTime = timestamp;
+    }
+
+    // Channel index by name, -1 if unknown
+    static int findChannel(const char *name)
+    {
+        for (size_t c = 0; c < CHANNEL_COUNT; c++)
+        {
+            if (strcmp(SCHEMA::channels[c].name, name) == 0)
+                return (int)c;
+        }
+        return -1;
+    }
+
+    static const channelSpec &getChannel(size_t c) { return SCHEMA::channels[c]; }
+
+    // Bytes of sample storage, disabled channels take none
+    static constexpr size_t getStorageSize() { return STORAGE_SIZE; }
+
+    uint32_t getCount(size_t c) const
+    {
+        uint32_t recorded = getRecorded(c);
+        uint32_t length = SCHEMA::channels[c].length;
+        return recorded < length ? recorded : length;
+    }
+
+    float getSample(size_t c, uint32_t i) const
+    {
+        const channelSpec &spec = SCHEMA::channels[c];
+        uint32_t slot = (getRecorded(c) - getCount(c) + i) & (spec.length - 1);
+        const uint8_t *data = _storage + channelOffset<SCHEMA>(c);
+        switch (spec.type)
+        {
+        case CHANNEL_U8:
+            return data[slot] / spec.scale;
+        case CHANNEL_U16:
+            return ((const uint16_t *)data)[slot] / spec.scale;
+        default:
+            return ((const int16_t *)data)[slot] / spec.scale;
+        }
+    }
+
+    // Timestamp of sample i, counted back from the last record at PERIOD_MS per tick
+    int getSampleTime(size_t c, uint32_t i) const
+    {
+        uint32_t decimation = SCHEMA::channels[c].decimation;
+        uint32_t tick = (getRecorded(c) - getCount(c) + i) * decimation;
+        return _lastTime - (int)((_ticks - 1 - tick) * SCHEMA::PERIOD_MS);
+    }
+
+private:
+    uint32_t _ticks; // Records since boot
+    int _lastTime;   // Timestamp of the last record (ms)
+    alignas(2) uint8_t _storage[STORAGE_SIZE > 0 ? STORAGE_SIZE : 1];
+
+    // Samples written to channel c since boot: ticks rounded up to the decimation
+    uint32_t getRecorded(size_t c) const
+    {
+        uint32_t decimation = SCHEMA::channels[c].decimation;
+        return (_ticks + decimation - 1) / decimation;
+    }
+
+    template <typename Read, size_t... C>
+    void recordChannels(Read &read, std::index_sequence<C...>)
+    {
+        (recordChannel<C>(read), ...);
+    }
+
+    template <size_t C, typename Read>
+    void recordChannel(Read &read)
+    {
+        constexpr channelSpec spec = SCHEMA::channels[C];
+        static_assert(spec.decimation > 0 && (spec.decimation & (spec.decimation - 1)) == 0,
+                      "channel decimation must be a power of two");
+        static_assert((spec.length & (spec.length - 1)) == 0, "channel length must be a power of two or 0");
+
+        if constexpr (spec.length > 0)
+        {
+            if ((_ticks & (spec.decimation - 1)) != 0)
+            {
+                return;
+            }
+            uint32_t slot = (_ticks / spec.decimation) & (spec.length - 1); // Constant powers of two: shift and mask
+            int32_t value = quantise(read(C) * spec.scale);
+            constexpr size_t OFFSET = channelOffset<SCHEMA>(C);
+            uint8_t *data = _storage + OFFSET;
+            if constexpr (spec.type == CHANNEL_U8)
+                data[slot] = (uint8_t)clamp(value, 0, 255);
+            else if constexpr (spec.type == CHANNEL_U16)
+                ((uint16_t *)data)[slot] = (uint16_t)clamp(value, 0, 65535);
+            else
+                ((int16_t *)data)[slot] = (int16_t)clamp(value, -32768, 32767);
+        }
+    }
+
+    static int32_t quantise(float value) { return (int32_t)(value >= 0.0f ? value + 0.5f : value - 0.5f); }
+    static int32_t clamp(int32_t value, int32_t low, int32_t high) { return value < low ? low : (value > high ? high : value); }
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef SLIDING_METRICS_H
+#define SLIDING_METRICS_H
+
+#include <stdint.h>
+#include "ring.h"
+
+// SlidingMetrics class definition
+// Energy, visibility error and flicker over the last BUCKETS buckets of TICKS_PER_BUCKET
+// control ticks. When a bucket closes its sums are added to the window totals and the bucket
+// leaving the window is subtracted, O(1) per tick. Buckets are kept in a Ring rounded up to
+// a power of two, so the window can be any length without a modulo per bucket.
+// Sums are integer fixed point, so adding and subtracting never drifts however long it runs.
+// The window moves in bucket steps (the open bucket is not included).
+// methods :
+// - add: one control tick (energy in duty * s, visibility error in LUX, flicker in duty)
+// - getEnergy / getVisibilityError / getFlicker: window sum, mean per tick, mean per tick
+// - getTicks: control ticks in the window
+template <uint16_t BUCKETS, uint8_t TICKS_PER_BUCKET>
+class SlidingMetrics
+{
+public:
+    SlidingMetrics() : _openTicks(0), _energy(0), _visibility(0), _flicker(0)
+    {
+        _open = {0, 0, 0};
+    }
+
+    void add(float energy, float visibility, float flicker)
+    {
+        _open.energy += toFixed(energy * ENERGY_SCALE);
+        _open.visibility += toFixed(visibility * VISIBILITY_SCALE);
+        _open.flicker += toFixed(flicker * FLICKER_SCALE);
+        if (++_openTicks < TICKS_PER_BUCKET)
+        {
+            return;
+        }
+
+        // Bucket closes: it enters the window, the oldest leaves once the window is full
+        if (_buckets.size() == BUCKETS)
+        {
+            const bucket &old = _buckets[0];
+            _energy -= old.energy;
+            _visibility -= old.visibility;
+            _flicker -= old.flicker;
+            _buckets.discard(1);
+        }
+        _energy += _open.energy;
+        _visibility += _open.visibility;
+        _flicker += _open.flicker;
+        _buckets.push(_open);
+
+        _open = {0, 0, 0};
+        _openTicks = 0;
+    }
+
+    // Window length in milliseconds at 100 Hz
+    uint32_t getLength() const { return (uint32_t)BUCKETS * TICKS_PER_BUCKET * 10; }
+
+    uint32_t getTicks() const { return _buckets.size() * TICKS_PER_BUCKET; }
+
+    // Sum of duty * s over the window
+    float getEnergy() const { return _energy / ENERGY_SCALE; }
+
+    // Mean per tick, as the lifetime averages
+    float getVisibilityError() const { return !_buckets.empty() ? _visibility / VISIBILITY_SCALE / getTicks() : 0.0f; }
+    float getFlicker() const { return !_buckets.empty() ? _flicker / FLICKER_SCALE / getTicks() : 0.0f; }
+
+private:
+    static constexpr float ENERGY_SCALE = 1e6f;     // 1e-6 duty * s
+    static constexpr float VISIBILITY_SCALE = 1e2f; // 1/100 LUX, as the history
+    static constexpr float FLICKER_SCALE = 1e5f;    // 1e-5 duty
+
+    struct bucket
+    {
+        int32_t energy, visibility, flicker;
+    };
+
+    Ring<bucket, ringCapacity(BUCKETS)> _buckets;
+    bucket _open;
+    uint8_t _openTicks;
+    int64_t _energy, _visibility, _flicker; // Window totals
+
+    static int32_t toFixed(float value) { return (int32_t)(value >= 0.0f ? value + 0.5f : value - 0.5f); }
+};
+
+#endif
@@ -0,0 +1,251 @@
+#include "compressedHistory.h"
+
+CompressedHistory::CompressedHistory()
+    : _oldest(0), _blockCount(0), _count(0), _sequence(0), _lastT(0), _lastDelta(0), _lastU(0), _lastY(0)
+{
+}
+
+void CompressedHistory::append(int timestamp, uint16_t u, uint16_t y)
+{
+    if (_blockCount == 0)
+    {
+        startBlock(timestamp, u, y);
+        return;
+    }
+
+    // Worst case 5 + 3 + 3 bytes
+    uint8_t code[11];
+    int delta = timestamp - _lastT;
+    uint8_t length = putVarint(code, zigzag(delta - _lastDelta));
+    length += putVarint(code + length, zigzag((int32_t)u - (int32_t)_lastU));
+    length += putVarint(code + length, zigzag((int32_t)y - (int32_t)_lastY));
+
+    block &b = _blocks[(_oldest + _blockCount - 1) & BLOCK_MASK];
+    if (b.used + length > PAYLOAD_BYTES || b.count == 255)
+    {
+        startBlock(timestamp, u, y);
+        return;
+    }
+
+    for (uint8_t i = 0; i < length; i++)
+    {
+        b.data[b.used + i] = code[i];
+    }
+    b.used += length;
+    b.count++;
+    _count++;
+
+    _lastT = timestamp;
+    _lastDelta = delta;
+    _lastU = u;
+    _lastY = y;
+}
+
+void CompressedHistory::startBlock(int timestamp, uint16_t u, uint16_t y)
+{
+    if (_blockCount == BLOCK_COUNT)
+    {
+        // Evict the oldest block whole, readers see the sequence change before the block does
+        _sequence++;
+        _count -= _blocks[_oldest].count;
+        _oldest = (_oldest + 1) & BLOCK_MASK;
+        _blockCount--;
+    }
+
+    block &b = _blocks[(_oldest + _blockCount) & BLOCK_MASK];
+    _blockCount++;
+    b.firstTime = timestamp;
+    b.firstU = u;
+    b.firstY = y;
+    b.count = 1;
+    b.used = 0;
+    _count++;
+
+    _lastT = timestamp;
+    _lastDelta = 0; // Delta-of-delta restarts in every block
+    _lastU = u;
+    _lastY = y;
+}
+
+uint16_t CompressedHistory::getCount() const
+{
+    return _count;
+}
+
+uint32_t CompressedHistory::getBytesUsed() const
+{
+    return (uint32_t)_blockCount * BLOCK_BYTES;
+}
+
+CompressedHistory::View CompressedHistory::getView() const
+{
+    View v;
+    v._history = this;
+    v._sequence = _sequence;
+    v._oldest = _oldest;
+    v._blockCount = _blockCount;
+    v._count = _count;
+    v._lastCount = _blockCount ? _blocks[(_oldest + _blockCount - 1) & BLOCK_MASK].count : 0;
+    return v;
+}
+
+CompressedHistory::Cursor CompressedHistory::begin(uint16_t first) const
+{
+    return getView().begin(first);
+}
+
+CompressedHistory::Cursor CompressedHistory::View::blockCursor(uint16_t index) const
+{
+    Cursor c;
+    c._history = _history;
+    c._sequence = _sequence;
+    c._index = index;
+    c._block = (_oldest + index) & BLOCK_MASK;
+    c._blocksLeft = _blockCount - index;
+    c._lastCount = _lastCount;
+    c._sample = 0;
+    c._offset = 0;
+    c._overrun = false;
+    c._end = INT32_MAX;
+    c._stride = 1;
+    c._t = c._delta = 0;
+    c._u = c._y = 0;
+    return c;
+}
+
+CompressedHistory::Cursor CompressedHistory::View::begin(uint16_t first) const
+{
+    // Skip whole blocks, then decode up to the first sample
+    const block *blocks = _history->_blocks;
+    uint16_t index = 0;
+    while (index < _blockCount && first >= blocks[(_oldest + index) & BLOCK_MASK].count)
+    {
+        first -= blocks[(_oldest + index) & BLOCK_MASK].count;
+        index++;
+    }
+    Cursor c = blockCursor(index);
+    sampleRecord skipped;
+    while (first-- > 0 && c.decode(skipped))
+    {
+    }
+    return c;
+}
+
+CompressedHistory::Cursor CompressedHistory::View::range(int t0, int t1, uint16_t stride) const
+{
+    // Last block starting at or before t0 (block start times are monotonic)
+    const block *blocks = _history->_blocks;
+    uint16_t lo = 0, hi = _blockCount;
+    while (lo < hi)
+    {
+        uint16_t mid = (lo + hi) / 2;
+        if (blocks[(_oldest + mid) & BLOCK_MASK].firstTime <= t0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    Cursor c = blockCursor(lo > 0 ? lo - 1 : 0);
+
+    // Decode up to the first sample in range, keeping the reader in front of it
+    Cursor ahead = c;
+    sampleRecord sample;
+    while (ahead.decode(sample) && sample.timestamp < t0)
+    {
+        c = ahead;
+    }
+    c._end = t1;
+    c._stride = stride > 0 ? stride : 1;
+    return c;
+}
+
+bool CompressedHistory::Cursor::next(sampleRecord &out)
+{
+    if (!decode(out) || out.timestamp > _end)
+    {
+        _blocksLeft = 0;
+        return false;
+    }
+
+    // Decimation: skip the next stride - 1 samples
+    sampleRecord skipped;
+    for (uint16_t i = 1; i < _stride; i++)
+    {
+        if (!decode(skipped))
+            break;
+    }
+    return true;
+}
+
+bool CompressedHistory::Cursor::decode(sampleRecord &out)
+{
+    if (_blocksLeft == 0)
+    {
+        return false;
+    }
+
+    const block &b = _history->_blocks[_block];
+    if (_sample == 0)
+    {
+        _t = b.firstTime;
+        _delta = 0;
+        _u = b.firstU;
+        _y = b.firstY;
+        _offset = 0;
+    }
+    else
+    {
+        _delta += unzigzag(getVarint(b.data, _offset));
+        _t += _delta;
+        _u = (uint16_t)(_u + unzigzag(getVarint(b.data, _offset)));
+        _y = (uint16_t)(_y + unzigzag(getVarint(b.data, _offset)));
+    }
+
+    // Checked after the decode: the n-th block of the view is reused by the (n+1)-th eviction
+    if (_history->_sequence - _sequence > _index)
+    {
+        _overrun = true;
+        _blocksLeft = 0;
+        return false;
+    }
+
+    out.timestamp = _t;
+    out.u = _u;
+    out.y = _y;
+
+    // The newest block may have grown since the view was taken
+    uint8_t count = _blocksLeft == 1 ? _lastCount : b.count;
+    if (++_sample >= count)
+    {
+        _sample = 0;
+        _block = (_block + 1) & BLOCK_MASK;
+        _blocksLeft--;
+        _index++;
+    }
+    return true;
+}
+
+uint8_t CompressedHistory::putVarint(uint8_t *out, uint32_t value)
+{
+    uint8_t length = 0;
+    while (value >= 0x80)
+    {
+        out[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (uint8_t)value;
+    return length;
+}
+
+uint32_t CompressedHistory::getVarint(const uint8_t *in, uint8_t &offset)
+{
+    uint32_t value = 0;
+    uint8_t shift = 0;
+    uint8_t byte;
+    do
+    {
+        byte = in[offset++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
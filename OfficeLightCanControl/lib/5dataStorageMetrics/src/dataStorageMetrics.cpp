@@ -3,84 +3,185 @@
 #include <Arduino.h>
 
 dataStorageMetrics::dataStorageMetrics() : 
-    head(0), 
-    count(0), 
-    isFull(false),
+    storedCount(0),
+    sampleCount(0),
+    skippedCount(0),
+    secondTier(1000),
+    minuteTier(60000),
+    minuteClosed(false),
+    performance(1.0f / SAMPLING_FREQ),
+    sampleTiming(SAMPLE_PERIOD_US),
+    controlTiming(1000000 / SAMPLING_FREQ),
+    lastDutyCycle(0.0f),
+    lastTimestamp(0),
+    prevDutyCycle(0.0f),
     energySum(0.0f),
     visibilityError(0.0f),
     flickerSum(0.0f) {
-    // Initialize buffers with zeros
-    for (uint16_t i = 0; i < STORAGE_BUFFER_SIZE; i++) {
-        uBuffer[i] = 0.0f;
-        yBuffer[i] = 0.0f;
-        rBuffer[i] = 0.0f;
-        timestampBuffer[i] = 0;
-    }
 }
 
 dataStorageMetrics::~dataStorageMetrics() {}
 
 void dataStorageMetrics::insertValues(float dutyCycle, float luxMeasured, float luxReference, int timestamp) {
-    // Update buffer count
-    if (count < STORAGE_BUFFER_SIZE) {
-        count++;
-    } else {
-        isFull = true;
-    }
+    sampleCount++;
     
-    // Store values in buffers
-    uBuffer[head] = dutyCycle;
-    yBuffer[head] = luxMeasured;
-    rBuffer[head] = luxReference;
-    timestampBuffer[head] = timestamp;
+    // Store packed values in the compressed history
+    uint16_t u = packDuty(dutyCycle);
+    uint16_t y = packLux(luxMeasured);
+    history.append(timestamp, u, y);
+
+    // Cascade into the downsampled tiers (a closed second feeds the minute tier)
+    historyEntry sample = {u, u, u, y, y, y};
+    if (secondTier.add(timestamp, sample)) {
+        if (minuteTier.add(secondTier.getLastClosedStart(), secondTier.getLastClosed())) {
+            minuteClosed = true;
+        }
+    }
 
-    // Update metrics incrementally
+    // Reference only on change
+    events.record(EVENT_REFERENCE, luxReference, timestamp);
+
+    // Update metrics incrementally (full precision, before the last sample is replaced)
+    metricsIndex.mark(timestamp);
     updateMetrics(dutyCycle, luxMeasured, luxReference, timestamp);
+    performance.update(luxReference, luxMeasured, dutyCycle);
+    errorQuantiles.add(fabsf(luxReference - luxMeasured));
+    prevDutyCycle = lastDutyCycle;
+    lastDutyCycle = dutyCycle;
+    lastTimestamp = timestamp;
+    storedCount++;
+}
+
+void dataStorageMetrics::insertSkipped(float luxMeasured, float luxReference) {
+    // Nothing is stored: the held duty cycle is integrated into the energy at the next
+    // insert (real timestamp difference) and a constant duty adds no flicker
+    sampleCount++;
+    skippedCount++;
+
+    float error = luxReference - luxMeasured;
+    float visibility = (error > 0) ? error : 0.0f;
+    visibilityError += visibility;
+    shortWindow.add(0.0f, visibility, 0.0f);
+    longWindow.add(0.0f, visibility, 0.0f);
+    metricsIndex.add(0.0f, visibility, 0.0f);
 
-    // Update head index
-    head = incrementIndex(head);
+    performance.update(luxReference, luxMeasured, lastDutyCycle);
+    errorQuantiles.add(fabsf(error));
 }
 
-uint16_t dataStorageMetrics::getBuffer(float* dutyCycleOut, float* luxOut, int* timestampsOut) {
-    uint16_t elements = isFull ? STORAGE_BUFFER_SIZE : count;
-    uint16_t current = isFull ? head : 0;
-    
-    for (uint16_t i = 0; i < elements; i++) {
-        dutyCycleOut[i] = uBuffer[current];
-        luxOut[i] = yBuffer[current];
-        timestampsOut[i] = timestampBuffer[current];
-        current = incrementIndex(current);
-    }
-    return elements;
+uint32_t dataStorageMetrics::getSkippedCount() {
+    return skippedCount;
 }
 
-uint16_t dataStorageMetrics::getUbuffer(float* uOut) {
-    uint16_t elements = isFull ? STORAGE_BUFFER_SIZE : count;
-    uint16_t current = isFull ? head : 0;
-    
-    for (uint16_t i = 0; i < elements; i++) {
-        uOut[i] = uBuffer[current];
-        current = incrementIndex(current);
-    }
-    return elements;
+void dataStorageMetrics::logEvent(EventType type, float value, int timestamp) {
+    events.record(type, value, timestamp);
 }
 
-uint16_t dataStorageMetrics::getYbuffer(float* yOut) {
-    uint16_t elements = isFull ? STORAGE_BUFFER_SIZE : count;
-    uint16_t current = isFull ? head : 0;
-    
-    for (uint16_t i = 0; i < elements; i++) {
-        yOut[i] = yBuffer[current];
-        current = incrementIndex(current);
+const EventLog &dataStorageMetrics::getEventLog() {
+    return events;
+}
+
+dataStorageMetrics::Recorder &dataStorageMetrics::getRecorder() {
+    return recorder;
+}
+
+PerformanceMonitor &dataStorageMetrics::getPerformanceMonitor() {
+    return performance;
+}
+
+void dataStorageMetrics::insertLoopTime(uint32_t elapsed) {
+    loopTimeQuantiles.add((float)elapsed);
+}
+
+QuantileSketch &dataStorageMetrics::getErrorQuantiles() {
+    return errorQuantiles;
+}
+
+QuantileSketch &dataStorageMetrics::getLoopTimeQuantiles() {
+    return loopTimeQuantiles;
+}
+
+LoopTiming &dataStorageMetrics::getSampleTiming() {
+    return sampleTiming;
+}
+
+LoopTiming &dataStorageMetrics::getControlTiming() {
+    return controlTiming;
+}
+
+uint16_t dataStorageMetrics::getCount() {
+    return history.getCount();
+}
+
+CompressedHistory::View dataStorageMetrics::getHistoryView() {
+    return history.getView();
+}
+
+CompressedHistory::Cursor dataStorageMetrics::getHistoryRange(int t0, int t1, uint16_t k) {
+    return history.getView().range(t0, t1, k);
+}
+
+uint16_t dataStorageMetrics::getTierCount(uint8_t tier) {
+    if (tier == 1) return secondTier.getCount();
+    if (tier == 2) return minuteTier.getCount();
+    return 0;
+}
+
+uint32_t dataStorageMetrics::getTierPeriod(uint8_t tier) {
+    if (tier == 1) return secondTier.getPeriod();
+    if (tier == 2) return minuteTier.getPeriod();
+    return 0;
+}
+
+uint16_t dataStorageMetrics::getTier(uint8_t tier, historyEntry* out, uint16_t first, uint16_t maxCount, int* firstTimestamp) {
+    uint16_t elements = getTierCount(tier);
+    if (first >= elements) return 0;
+    if (maxCount > elements - first) maxCount = elements - first;
+
+    for (uint16_t i = 0; i < maxCount; i++) {
+        out[i] = (tier == 1) ? secondTier.getEntry(first + i) : minuteTier.getEntry(first + i);
     }
-    return elements;
+    *firstTimestamp = (tier == 1) ? secondTier.getStart(first) : minuteTier.getStart(first);
+    return maxCount;
+}
+
+float dataStorageMetrics::unpackDuty(uint16_t value) {
+    return value / DUTY_SCALE;
+}
+
+float dataStorageMetrics::unpackLux(uint16_t value) {
+    return value / LUX_SCALE;
+}
+
+void dataStorageMetrics::getState(metricsState &state) {
+    state.sampleCount = sampleCount;
+    state.skippedCount = skippedCount;
+    state.energySum = energySum;
+    state.visibilityError = visibilityError;
+    state.flickerSum = flickerSum;
+    state.minute = minuteTier.getLastClosed();
+    state.minuteStart = minuteTier.getLastClosedStart();
+}
+
+void dataStorageMetrics::setState(const metricsState &state) {
+    sampleCount = state.sampleCount;
+    skippedCount = state.skippedCount;
+    energySum = state.energySum;
+    visibilityError = state.visibilityError;
+    flickerSum = state.flickerSum;
+}
+
+bool dataStorageMetrics::consumeMinuteClosed() {
+    bool closed = minuteClosed;
+    minuteClosed = false;
+    return closed;
 }
 
 float dataStorageMetrics::getPowerConsumption() 
 {
     float instantPower = 0.0f;
-    instantPower = uBuffer[head] * LED_MAX_POWER; // Convert duty cycle to percentage
-    Serial.printf("Duty cycle: %.2f, Instant power: %.2f\n", uBuffer[head], instantPower);
+    instantPower = lastDutyCycle * LED_MAX_POWER; // Convert duty cycle to percentage
+    Serial.printf("Duty cycle: %.2f, Instant power: %.2f\n", lastDutyCycle, instantPower);
     return instantPower;
 }
     
@@ -90,57 +191,83 @@ float dataStorageMetrics::getEnergy() {
 }
 
 float dataStorageMetrics::getVisibilityError() {
-    if (count == 0) return 0.0f;
-    return visibilityError / count;
+    if (sampleCount == 0) return 0.0f;
+    return visibilityError / sampleCount;
 }
 
 float dataStorageMetrics::getFlicker() {
-    if (count < 2) return 0.0f; // Flicker calculation requires at least 2 samples
-    return flickerSum / count;
+    if (sampleCount < 2) return 0.0f; // Flicker calculation requires at least 2 samples
+    return flickerSum / sampleCount;
+}
+
+uint32_t dataStorageMetrics::getWindowLength(uint8_t window) {
+    if (window == 0) return shortWindow.getLength();
+    if (window == 1) return longWindow.getLength();
+    return 0;
 }
 
-uint16_t dataStorageMetrics::incrementIndex(uint16_t idx) {
-    return (idx + 1) % STORAGE_BUFFER_SIZE;
+float dataStorageMetrics::getWindowEnergy(uint8_t window) {
+    return (window == 0 ? shortWindow.getEnergy() : longWindow.getEnergy()) * LED_MAX_POWER;
+}
+
+float dataStorageMetrics::getWindowVisibilityError(uint8_t window) {
+    return window == 0 ? shortWindow.getVisibilityError() : longWindow.getVisibilityError();
+}
+
+float dataStorageMetrics::getWindowFlicker(uint8_t window) {
+    return window == 0 ? shortWindow.getFlicker() : longWindow.getFlicker();
+}
+
+bool dataStorageMetrics::getRangeMetrics(int t0, int t1, rangeMetrics &out) {
+    if (!metricsIndex.query(t0, t1, out)) return false;
+    out.energy *= LED_MAX_POWER;
+    return true;
 }
 
 void dataStorageMetrics::updateMetrics(float dutyCycle, float luxMeasured, float luxReference, int timestamp) {
+    // Contributions of this sample, added to the lifetime and the sliding-window sums
+    float energy = 0.0f;
+    float visibility = 0.0f;
+    float flicker = 0.0f;
+
     // Energy calculation requires previous sample
-    if (count > 1) {
-        uint16_t prevIdx = (head - 1 + STORAGE_BUFFER_SIZE) % STORAGE_BUFFER_SIZE;
-        float timeDiff = (timestamp - timestampBuffer[prevIdx]) / 1000.0f;  // ms to s
-        energySum += uBuffer[prevIdx] * timeDiff;                                  // Will be multiplied by LED_MAX_POWER later
+    if (storedCount > 0) {
+        float timeDiff = (timestamp - lastTimestamp) / 1000.0f;  // ms to s
+        energy = lastDutyCycle * timeDiff;                        // Will be multiplied by LED_MAX_POWER later
     }
 
     // Visibility error
     float error = luxReference - luxMeasured;
-    visibilityError += (error > 0) ? error : 0.0f;
+    visibility = (error > 0) ? error : 0.0f;
 
     // Flicker calculation (requires at least 2 previous samples)
-    if (count >= 2) {
-        uint16_t prev1 = (head - 1 + STORAGE_BUFFER_SIZE) % STORAGE_BUFFER_SIZE;        // Previous sample index (t-1)
-        uint16_t prev2 = (head - 2 + STORAGE_BUFFER_SIZE) % STORAGE_BUFFER_SIZE;        // Sample before previous (t-2)
-
-        // Serial.printf("Flicker: prev1 = %d, prev2 = %d\n", prev1, prev2);
-
-        if (luxReference != rBuffer[prev1])
-        {
-            // Serial.println("Flicker calculation error: Reference lux changed.");
-            return;  // Skip if reference has lux changed
-        }
-        if (luxReference != rBuffer[prev2]) 
-        {
-            // Serial.println("Flicker calculation error: Reference lux changed.");
-            return;  // Skip if reference has lux changed
-        }
-
-        float diff1 = uBuffer[head] - uBuffer[prev1];
-        float diff2 = uBuffer[prev1] - uBuffer[prev2];
+    // Skipped if the reference changed at this sample or the previous one
+    int referenceChange = 0;
+    events.getLastChange(EVENT_REFERENCE, referenceChange);
+    if (storedCount >= 2 && referenceChange < lastTimestamp) {
+        float diff1 = dutyCycle - lastDutyCycle;
+        float diff2 = lastDutyCycle - prevDutyCycle;
 
-        // Serial.printf("Flicker: diff1 = %f, diff2 = %f\n", diff1, diff2);
-        
         if ((diff1 * diff2) < 0) {  // Sign change detected
-            // Serial.println("Flicker: Sign change detected.");
-            flickerSum += (abs(diff1) + abs(diff2));
+            flicker = abs(diff1) + abs(diff2);
         }
     }
-}
\ No newline at end of file
+
+    energySum += energy;
+    visibilityError += visibility;
+    flickerSum += flicker;
+    shortWindow.add(energy, visibility, flicker);
+    longWindow.add(energy, visibility, flicker);
+    metricsIndex.add(energy, visibility, flicker);
+}
+
+uint16_t dataStorageMetrics::packDuty(float dutyCycle) {
+    return (uint16_t)(constrain(dutyCycle, 0.0f, 1.0f) * DUTY_SCALE + 0.5f);
+}
+
+uint16_t dataStorageMetrics::packLux(float lux) {
+    float scaled = lux * LUX_SCALE + 0.5f;
+    if (scaled < 0.0f) return 0;
+    if (scaled > 65535.0f) return 65535;
+    return (uint16_t)scaled;
+}
@@ -0,0 +1,52 @@
+#include "eventLog.h"
+
+EventLog::EventLog()
+{
+    for (uint8_t i = 0; i < EVENT_TYPE_COUNT; i++)
+    {
+        _seen[i] = false;
+        _lastValue[i] = 0.0f;
+        _lastTime[i] = 0;
+    }
+}
+
+bool EventLog::record(EventType type, float value, int timestamp)
+{
+    if (type >= EVENT_TYPE_COUNT || (_seen[type] && _lastValue[type] == value))
+    {
+        return false;
+    }
+
+    _seen[type] = true;
+    _lastValue[type] = value;
+    _lastTime[type] = timestamp;
+
+    _records.pushOverwrite({timestamp, value, type});
+    return true;
+}
+
+uint8_t EventLog::getCount() const
+{
+    return _records.size();
+}
+
+const eventRecord &EventLog::get(uint8_t i) const
+{
+    return _records[i];
+}
+
+bool EventLog::getLastChange(EventType type, int &timestamp) const
+{
+    if (type >= EVENT_TYPE_COUNT || !_seen[type])
+    {
+        return false;
+    }
+    timestamp = _lastTime[type];
+    return true;
+}
+
+char EventLog::getLetter(EventType type)
+{
+    static const char letters[EVENT_TYPE_COUNT] = {'r', 'o', 'f', 'a', 'u', 'c', 'm', 'j', 'n', 'w', 'k', 'x'};
+    return type < EVENT_TYPE_COUNT ? letters[type] : '?';
+}
@@ -0,0 +1,233 @@
+#include "flashRing.h"
+
+FlashRing::FlashRing(uint32_t flashOffset, uint32_t sectorCount, uint32_t magic)
+    : _flashOffset(flashOffset), _sectorCount(sectorCount), _slotCount(sectorCount * SLOTS_PER_SECTOR),
+      _magic(magic), _head(0), _sequence(0), _newest(-1), _ahead(SECTOR_UNKNOWN), _staged(false)
+{
+}
+
+void FlashRing::begin()
+{
+    // Records are appended in order, so the newest sector is the one whose first valid
+    // record has the highest sequence number: read one slot per sector (torn slots skipped)
+    int32_t newestSector = -1;
+    uint32_t newestSequence = 0;
+    for (uint32_t sector = 0; sector < _sectorCount; sector++)
+    {
+        for (uint32_t slot = sector * SLOTS_PER_SECTOR; slot < (sector + 1) * SLOTS_PER_SECTOR; slot++)
+        {
+            if (slotIsErased(slot))
+                break;
+            if (!slotIsValid(slot))
+                continue;
+            uint32_t sequence = slotAddress(slot)->sequence;
+            if (newestSector < 0 || (int32_t)(sequence - newestSequence) > 0)
+            {
+                newestSector = sector;
+                newestSequence = sequence;
+            }
+            break;
+        }
+    }
+
+    // Then the newest record and the head inside that sector
+    _head = 0;
+    if (newestSector >= 0)
+    {
+        uint32_t first = newestSector * SLOTS_PER_SECTOR;
+        _head = (first + SLOTS_PER_SECTOR) % _slotCount; // Sector full unless an erased slot is found
+        for (uint32_t slot = first; slot < first + SLOTS_PER_SECTOR; slot++)
+        {
+            if (slotIsValid(slot))
+            {
+                _newest = slot;
+                _sequence = slotAddress(slot)->sequence + 1;
+            }
+            else if (slotIsErased(slot))
+            {
+                _head = slot;
+                break;
+            }
+        }
+    }
+
+    // Boot time: no control loop is running yet, so prepare the head sector now
+    uint32_t sector = _head / SLOTS_PER_SECTOR;
+    if (_head % SLOTS_PER_SECTOR == 0 && !sectorIsErased(sector))
+    {
+        eraseSector(sector);
+    }
+    _ahead = SECTOR_UNKNOWN;
+}
+
+const uint8_t *FlashRing::getNewest() const
+{
+    return _newest < 0 ? nullptr : slotAddress(_newest)->payload;
+}
+
+void FlashRing::append(const void *payload, size_t length)
+{
+    memset(&_record, 0, sizeof(_record)); // Deterministic padding for the CRC
+    memcpy(_record.payload, payload, length < PAYLOAD_SIZE ? length : PAYLOAD_SIZE);
+    _staged = true;
+}
+
+const uint8_t *FlashRing::getRecord(uint32_t n, uint32_t &sequence) const
+{
+    // Oldest sector is the one after the head sector
+    uint32_t slot = (aheadSector() * SLOTS_PER_SECTOR + n) % _slotCount;
+    if (n >= _slotCount || !slotIsValid(slot))
+    {
+        return nullptr;
+    }
+
+    sequence = slotAddress(slot)->sequence;
+    return slotAddress(slot)->payload;
+}
+
+bool FlashRing::canProgram() const
+{
+    return _staged && ((_head + 1) % SLOTS_PER_SECTOR != 0 || _ahead == SECTOR_ERASED);
+}
+
+void FlashRing::program()
+{
+    _record.magic = _magic;
+    _record.sequence = _sequence++;
+    _record.crc = crc32((const uint8_t *)&_record, offsetof(record, crc));
+
+    // Program the whole page, 0xFF leaves the other slots untouched
+    uint8_t page[FLASH_PAGE_SIZE];
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page + (_head % SLOTS_PER_PAGE) * SLOT_SIZE, &_record, sizeof(_record));
+
+    uint32_t pageOffset = _flashOffset + (_head / SLOTS_PER_PAGE) * FLASH_PAGE_SIZE;
+    noInterrupts();
+    flash_range_program(pageOffset, page, FLASH_PAGE_SIZE);
+    interrupts();
+
+    _newest = _head;
+    _head = (_head + 1) % _slotCount;
+    _staged = false;
+    if (_head % SLOTS_PER_SECTOR == 0)
+    {
+        _ahead = SECTOR_UNKNOWN; // Head entered the sector erased ahead, the next one holds old records
+    }
+}
+
+bool FlashRing::needsErase()
+{
+    if (_ahead == SECTOR_UNKNOWN)
+    {
+        _ahead = sectorIsErased(aheadSector()) ? SECTOR_ERASED : SECTOR_DIRTY;
+    }
+    return _ahead == SECTOR_DIRTY;
+}
+
+void FlashRing::eraseAhead()
+{
+    eraseSector(aheadSector());
+    _ahead = SECTOR_ERASED;
+}
+
+const FlashRing::record *FlashRing::slotAddress(uint32_t slot) const
+{
+    return (const record *)(XIP_BASE + _flashOffset + slot * SLOT_SIZE);
+}
+
+bool FlashRing::slotIsValid(uint32_t slot) const
+{
+    const record *rec = slotAddress(slot);
+    return rec->magic == _magic && rec->crc == crc32((const uint8_t *)rec, offsetof(record, crc));
+}
+
+bool FlashRing::slotIsErased(uint32_t slot) const
+{
+    const uint32_t *words = (const uint32_t *)slotAddress(slot);
+    for (uint32_t i = 0; i < SLOT_SIZE / sizeof(uint32_t); i++)
+    {
+        if (words[i] != 0xFFFFFFFF)
+            return false;
+    }
+    return true;
+}
+
+bool FlashRing::sectorIsErased(uint32_t sector) const
+{
+    for (uint32_t slot = sector * SLOTS_PER_SECTOR; slot < (sector + 1) * SLOTS_PER_SECTOR; slot++)
+    {
+        if (!slotIsErased(slot))
+            return false;
+    }
+    return true;
+}
+
+void FlashRing::eraseSector(uint32_t sector)
+{
+    noInterrupts();
+    flash_range_erase(_flashOffset + sector * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE);
+    interrupts();
+}
+
+uint32_t FlashRing::crc32(const uint8_t *data, size_t length)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+FlashScheduler::FlashScheduler()
+    : _ringCount(0), _next(0), _programTime(PROGRAM_TIME)
+{
+}
+
+bool FlashScheduler::add(FlashRing &ring)
+{
+    if (_ringCount == MAX_RINGS)
+    {
+        return false;
+    }
+    _rings[_ringCount++] = &ring;
+    return true;
+}
+
+bool FlashScheduler::service(uint32_t slack, bool idle)
+{
+    // Staged records first, the ring after the one served last goes first
+    if (slack >= _programTime)
+    {
+        for (uint8_t i = 0; i < _ringCount; i++)
+        {
+            FlashRing &ring = *_rings[(_next + i) % _ringCount];
+            if (ring.canProgram())
+            {
+                uint32_t start = micros();
+                ring.program();
+                _programTime = (3 * _programTime + (micros() - start)) / 4;
+                _next = (_next + i + 1) % _ringCount;
+                return true;
+            }
+        }
+    }
+
+    // Erase ahead only at steady state, the loop stalls for the whole erase
+    if (idle)
+    {
+        for (uint8_t i = 0; i < _ringCount; i++)
+        {
+            if (_rings[i]->needsErase())
+            {
+                _rings[i]->eraseAhead();
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,82 @@
+#include "loopTiming.h"
+#include <string.h>
+
+LoopTiming::LoopTiming(uint32_t periodUs) : _target(periodUs)
+{
+    reset();
+}
+
+void LoopTiming::start(uint32_t nowUs, unsigned long nowMs)
+{
+    _lateness = 0;
+    if (_started)
+    {
+        uint32_t period = nowUs - _lastStart; // Wraps correctly with micros()
+        _periodBins[binIndex(period)]++;
+        _periodSum += period;
+        _periods++;
+        if (period > _worstPeriod)
+        {
+            _worstPeriod = period;
+            _worstPeriodTime = nowMs;
+        }
+        _lateness = period > _target ? period - _target : 0;
+    }
+    _started = true;
+    _lastStart = nowUs;
+    _startMs = nowMs;
+}
+
+uint32_t LoopTiming::stop(uint32_t nowUs)
+{
+    uint32_t execution = nowUs - _lastStart;
+    _executionBins[binIndex(execution)]++;
+    _steps++;
+    if (execution > _worstExecution)
+    {
+        _worstExecution = execution;
+        _worstExecutionTime = _startMs;
+    }
+    if (_lateness + execution > _target)
+    {
+        _misses++;
+    }
+    return execution;
+}
+
+void LoopTiming::reset()
+{
+    _lastStart = 0;
+    _startMs = 0;
+    _lateness = 0;
+    _started = false;
+    _steps = _periods = _misses = 0;
+    _periodSum = 0;
+    _worstPeriod = _worstExecution = 0;
+    _worstPeriodTime = _worstExecutionTime = 0;
+    memset(_periodBins, 0, sizeof(_periodBins));
+    memset(_executionBins, 0, sizeof(_executionBins));
+}
+
+uint32_t LoopTiming::getBinLower(uint8_t i)
+{
+    if (i < SUB_BINS)
+    {
+        return i; // 0 to 3 us, one bin each
+    }
+    uint8_t octave = i / SUB_BINS + SUB_BITS - 1;
+    return (1u << octave) + (uint32_t)(i % SUB_BINS) * (1u << (octave - SUB_BITS));
+}
+
+uint8_t LoopTiming::binIndex(uint32_t us)
+{
+    if (us < SUB_BINS)
+    {
+        return (uint8_t)us;
+    }
+
+    // Octave from the leading one, position in the octave from the next SUB_BITS bits
+    uint8_t octave = 31 - __builtin_clz(us);
+    uint8_t index = (octave - SUB_BITS + 1) * SUB_BINS + ((us >> (octave - SUB_BITS)) & (SUB_BINS - 1));
+    return index < BIN_COUNT ? index : BIN_COUNT - 1;
+}
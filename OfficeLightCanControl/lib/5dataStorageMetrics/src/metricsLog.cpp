@@ -0,0 +1,58 @@
+#include "metricsLog.h"
+
+MetricsLog::MetricsLog(uint32_t flashOffset)
+    : _ring(flashOffset, SECTOR_COUNT, MAGIC)
+{
+}
+
+void MetricsLog::begin()
+{
+    _ring.begin();
+    Serial.printf("Metrics log: newest slot %ld, head slot %lu\n", (long)_ring.getNewestSlot(),
+                  (unsigned long)_ring.getHeadSlot());
+}
+
+bool MetricsLog::restore(dataStorageMetrics &metrics)
+{
+    const uint8_t *payload = _ring.getNewest();
+    if (payload == nullptr)
+    {
+        return false;
+    }
+
+    metricsState state;
+    memcpy(&state, payload, sizeof(state));
+    metrics.setState(state);
+    return true;
+}
+
+bool MetricsLog::service(dataStorageMetrics &metrics)
+{
+    if (!metrics.consumeMinuteClosed())
+    {
+        return false;
+    }
+
+    metricsState state;
+    memset(&state, 0, sizeof(state)); // Deterministic padding for the CRC
+    metrics.getState(state);
+    _ring.append(&state, sizeof(state));
+    return true;
+}
+
+bool MetricsLog::getRecord(uint32_t n, metricsState &state, uint32_t &sequence) const
+{
+    const uint8_t *payload = _ring.getRecord(n, sequence);
+    if (payload == nullptr)
+    {
+        return false;
+    }
+
+    memcpy(&state, payload, sizeof(state));
+    return true;
+}
+
+FlashRing &MetricsLog::getRing()
+{
+    return _ring;
+}
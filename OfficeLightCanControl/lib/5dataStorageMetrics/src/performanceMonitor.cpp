@@ -0,0 +1,102 @@
+#include "performanceMonitor.h"
+
+PerformanceMonitor::PerformanceMonitor(float h, float window)
+    : _h(h), _window(window), _lambda(expf(-h / window)),
+      _iae(0.0f), _ise(0.0f), _itae(0.0f), _saturation(0.0f), _crossings(0.0f),
+      _lastR(0.0f), _tStep(0.0f), _errorSign(0)
+{
+}
+
+void PerformanceMonitor::update(float r, float y, float u)
+{
+    float e = r - y;
+    float absE = fabsf(e);
+
+    // ITAE time base restarts on every reference change
+    if (r != _lastR)
+    {
+        _lastR = r;
+        _tStep = 0.0f;
+    }
+    _tStep += _h;
+
+    _iae = _lambda * _iae + absE * _h;
+    _ise = _lambda * _ise + e * e * _h;
+    _itae = _lambda * _itae + _tStep * absE * _h;
+
+    bool saturated = (u <= 0.0f || u >= 1.0f);
+    _saturation = _lambda * _saturation + (1.0f - _lambda) * (saturated ? 1.0f : 0.0f);
+
+    // Zero crossings of the error, ignoring noise inside the band
+    _crossings *= _lambda;
+    if (absE > CROSSING_BAND)
+    {
+        int8_t sign = (e > 0) ? 1 : -1;
+        if (_errorSign != 0 && sign != _errorSign)
+        {
+            _crossings += 1.0f;
+        }
+        _errorSign = sign;
+    }
+}
+
+float PerformanceMonitor::getIAE()
+{
+    return _iae;
+}
+
+float PerformanceMonitor::getISE()
+{
+    return _ise;
+}
+
+float PerformanceMonitor::getITAE()
+{
+    return _itae;
+}
+
+float PerformanceMonitor::getSaturation()
+{
+    return _saturation;
+}
+
+float PerformanceMonitor::getOscillation()
+{
+    return _crossings / _window;
+}
+
+static uint16_t toFixed16(float value, float scale)
+{
+    float v = value * scale;
+    if (v < 0.0f)
+        return 0;
+    if (v > 65535.0f)
+        return 65535;
+    return (uint16_t)v;
+}
+
+void PerformanceMonitor::pack(uint8_t *data)
+{
+    uint16_t iae = toFixed16(_iae, 100.0f);   // 0.01 LUX*s
+    uint16_t ise = toFixed16(_ise, 10.0f);    // 0.1 LUX^2*s
+    uint16_t itae = toFixed16(_itae, 10.0f);  // 0.1 LUX*s^2
+    float osc = getOscillation() * 10.0f;     // 0.1 crossings per second
+
+    data[0] = iae & 0xFF;
+    data[1] = iae >> 8;
+    data[2] = ise & 0xFF;
+    data[3] = ise >> 8;
+    data[4] = itae & 0xFF;
+    data[5] = itae >> 8;
+    data[6] = (uint8_t)(_saturation * 255.0f);
+    data[7] = (osc > 255.0f) ? 255 : (uint8_t)osc;
+}
+
+void PerformanceMonitor::unpack(const uint8_t *data, float *values)
+{
+    values[0] = (data[0] | (data[1] << 8)) / 100.0f;
+    values[1] = (data[2] | (data[3] << 8)) / 10.0f;
+    values[2] = (data[4] | (data[5] << 8)) / 10.0f;
+    values[3] = data[6] / 255.0f;
+    values[4] = data[7] / 10.0f;
+}
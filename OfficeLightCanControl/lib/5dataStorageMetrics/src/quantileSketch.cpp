@@ -0,0 +1,94 @@
+#include "quantileSketch.h"
+#include <string.h>
+#include <math.h>
+
+QuantileSketch::QuantileSketch()
+{
+    reset();
+}
+
+void QuantileSketch::add(float value)
+{
+    _bins[binIndex(value)]++;
+    if (++_count < HALVING_COUNT)
+    {
+        return;
+    }
+
+    // Fade out the old samples (bounded, BIN_COUNT shifts once every HALVING_COUNT samples)
+    _count = 0;
+    for (uint16_t i = 0; i < BIN_COUNT; i++)
+    {
+        _bins[i] >>= 1;
+        _count += _bins[i];
+    }
+}
+
+float QuantileSketch::getQuantile(float q) const
+{
+    if (_count == 0)
+    {
+        return 0.0f;
+    }
+
+    // Smallest bin whose cumulative count reaches the rank
+    uint32_t rank = (uint32_t)ceilf(q * _count);
+    if (rank == 0)
+        rank = 1;
+    uint32_t cumulative = 0;
+    for (uint16_t i = 0; i < BIN_COUNT; i++)
+    {
+        cumulative += _bins[i];
+        if (cumulative >= rank)
+        {
+            return binValue(i);
+        }
+    }
+    return binValue(BIN_COUNT - 1);
+}
+
+uint32_t QuantileSketch::getCount() const
+{
+    return _count;
+}
+
+void QuantileSketch::reset()
+{
+    memset(_bins, 0, sizeof(_bins));
+    _count = 0;
+}
+
+uint16_t QuantileSketch::binIndex(float value)
+{
+    // Octave from the biased exponent, position in the octave from the top mantissa bits
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if (bits & 0x80000000)
+    {
+        return 0; // Negative
+    }
+    int exponent = (int)(bits >> 23) - 127;
+    if (exponent < MIN_EXPONENT)
+    {
+        return 0;
+    }
+    if (exponent >= MAX_EXPONENT)
+    {
+        return BIN_COUNT - 1;
+    }
+    return (uint16_t)((exponent - MIN_EXPONENT) * SUB_BINS + ((bits >> (23 - SUB_BITS)) & (SUB_BINS - 1)) + 1);
+}
+
+float QuantileSketch::binValue(uint16_t bin)
+{
+    if (bin == 0)
+    {
+        return 0.0f;
+    }
+
+    // Middle of the bin
+    bin--;
+    int exponent = bin / SUB_BINS + MIN_EXPONENT;
+    float fraction = 1.0f + ((bin % SUB_BINS) + 0.5f) / SUB_BINS;
+    return ldexpf(fraction, exponent);
+}
@@ -14,6 +14,7 @@ bool gains_stashed = false;
 // Time configurations
 unsigned long LastUpdate_500Hz = 0;
 unsigned long LastUpdate_100Hz = 0;
+float trackingError = 0; // |reference - lux| of the last control tick, also the skipped ones
 
 // Initialize LuxMeter
 LuxMeter luxMeter(LDR_PIN, Vcc, R_fixed, ADC_RANGE, DAC_RANGE);
@@ -33,11 +34,20 @@ CANHandler canHandler(spi0, CAN_CS, SPI_MOSI, SPI_MISO, SPI_SCK, SPI_CLK_SPEED);
 // Instantiate the NetworkBoot class.
 NetworkBoot networkBoot;
 
+// Controller state snapshots in flash for warm restart
+ControllerSnapshot snapshot(SNAPSHOT_FLASH_OFFSET, SNAPSHOT_PERIOD);
+
+// Per-minute metrics records in flash, survive a reset
+MetricsLog metricsLog(METRICS_LOG_FLASH_OFFSET);
+
+// Writes the flash rings outside the control step
+FlashScheduler flashScheduler;
+
 CalibrationManager* calibrator = nullptr;
 bool calibration_ready = false;
 
 // Serial Interface to comunicate with PC
-pcInterface interface(luxMeter, driver, pidController, metrics, canHandler);
+pcInterface interface(luxMeter, driver, pidController, metrics, metricsLog, canHandler);
 
 
 void setup()
@@ -50,12 +60,22 @@ void setup()
     analogWriteRange(DAC_RANGE);
     pinMode(LED_PIN, OUTPUT_12MA);
 
+    pidController.setCascadeParameters(FREQ_500Hz / 1000.0f, 0.5f); // Inner loop runs at the sampling rate
+
     if (!canHandler.begin(CAN_1000KBPS)) {
         Serial.println("CAN initialization failed!");
         while(1); // halt if CAN initialization fails
     }
 
     raspConfig(); // Configure the Raspberry Pi based on its unique ID
+    snapshot.begin(); // Locate the newest controller snapshot in flash
+    flashScheduler.add(snapshot.getRing());
+    metricsLog.begin(); // Locate the newest metrics record in flash
+    flashScheduler.add(metricsLog.getRing());
+    if (metricsLog.restore(metrics)) // Keep energy, visibility error and flicker across resets
+    {
+        Serial.println("Metrics restored from flash.");
+    }
     networkBoot.begin(); // Start the network boot process
 
 
@@ -89,6 +109,19 @@ void loop()
         float offset = calibrator->getOffset();
         driver.setGainOffset(gain, offset);
         pidController.setGainAndExternal(gain, offset); // Set the gain and external illuminance in the controller
+
+        // Coupling gains of the other desks for the neighbour feedforward
+        const uint8_t* nodeIds = networkBoot.getDiscoveredNodeIDs();
+        for (int i = 0; i < networkBoot.getNodeCount(); ++i) {
+            if (nodeIds[i] != networkBoot.myNodeId) {
+                pidController.setNeighbourGain(nodeIds[i], gains[i]);
+            }
+        }
+
+        if (snapshot.restore(pidController)) // Warm restart from the last snapshot
+        {
+            Serial.println("Controller state restored from flash.");
+        }
         gains_stashed = true;
         return;
     }
@@ -99,28 +132,97 @@ void loop()
 
     if (currentMillis - LastUpdate_500Hz >= FREQ_500Hz) {
         LastUpdate_500Hz = currentMillis;
+        metrics.getSampleTiming().start(micros(), currentMillis); // Sampling period jitter
         
         luxMeter.updateMovingAverage();
+
+        // Cascade inner loop runs on every fresh sample
+        if (pidController.getCascadeActive()) {
+            driver.setDutyCycle(pidController.compute_inner(luxMeter.getLuxValue()));
+        }
+        metrics.getSampleTiming().stop(micros());
     }
 
     if (currentMillis - LastUpdate_100Hz >= FREQ_100Hz) {
         LastUpdate_100Hz = currentMillis;
+        metrics.getControlTiming().start(micros(), currentMillis); // Control period jitter and execution time
 
         // Get lux value (thread-safe)
         float measuredLux = luxMeter.getLuxValue();
     
-        // PID control (thread-safe)
-        float dutyCycle = pidController.compute_control();
-    
-        // Set duty cycle (thread-safe)
-        dutyCycle = driver.setDutyCycle(dutyCycle);
-    
-        // Update PID (thread-safe)
-        pidController.housekeep(measuredLux);
+        float dutyCycle = driver.getDutyCycle();
         reference = pidController.getReference();
-    
-        // Update metrics (thread-safe)
-        metrics.insertValues(dutyCycle, measuredLux, reference, currentMillis);
+
+        // Event-triggered mode: only compute and actuate when the error or measurement moved
+        if (pidController.eventTrigger(measuredLux, currentMillis)) {
+            // PID control (thread-safe)
+            dutyCycle = pidController.compute_control();
+
+            // Cascade: the outer tick only moves the operating point, the applied (and
+            // recorded) duty cycle keeps the inner proportional correction
+            if (pidController.getCascadeActive()) {
+                dutyCycle = pidController.compute_inner(measuredLux);
+            }
+        
+            // Set duty cycle (thread-safe)
+            dutyCycle = driver.setDutyCycle(dutyCycle);
+
+            // Tell the neighbours about the new duty cycle (only sent on change)
+            interface.announceDutyCycle(dutyCycle);
+        
+            // Update PID (thread-safe)
+            pidController.housekeep(measuredLux);
+            reference = pidController.getReference();
+        
+            // Update metrics (thread-safe)
+            metrics.insertValues(dutyCycle, measuredLux, reference, currentMillis);
+        }
+        else {
+            // Duty cycle held: energy is integrated over the real interval at the next insert
+            metrics.insertSkipped(measuredLux, reference);
+        }
+
+        // Measured on every tick, the controller error is stale while event-triggered steps are skipped
+        trackingError = fabsf(reference - measuredLux);
+
+        // Mode changes into the event log (appended only on change)
+        metrics.logEvent(EVENT_OCCUPANCY, pidController.getOccupancy(), currentMillis);
+        metrics.logEvent(EVENT_FEEDBACK, pidController.getFeedback(), currentMillis);
+        metrics.logEvent(EVENT_ANTI_WINDUP, pidController.getAntiWindup(), currentMillis);
+        metrics.logEvent(EVENT_MANUAL, driver.getManualMode(), currentMillis);
+        metrics.logEvent(EVENT_STRATEGY, pidController.getStrategy(), currentMillis);
+        metrics.logEvent(EVENT_MPC, pidController.getMpc(), currentMillis);
+        metrics.logEvent(EVENT_TRAJECTORY, pidController.getTrajectory(), currentMillis);
+        metrics.logEvent(EVENT_NEIGHBOUR_FF, pidController.getNeighbourFeedforward(), currentMillis);
+        metrics.logEvent(EVENT_TRIGGERED, pidController.getEventTriggered(), currentMillis);
+        metrics.logEvent(EVENT_CASCADE, pidController.getCascade(), currentMillis);
+        metrics.logEvent(EVENT_SMITH, pidController.getSmith(), currentMillis);
+
+        // Extra signals, only the channels enabled in recorderSchema are read
+        metrics.getRecorder().record(currentMillis, [&](size_t channel) -> float {
+            switch (channel) {
+            case REC_DUTY: return dutyCycle;
+            case REC_LUX: return measuredLux;
+            case REC_REFERENCE: return reference;
+            case REC_LDR_VOLTAGE: return luxMeter.getLdrVoltage();
+            case REC_EXTERNAL: return pidController.getExternal();
+            case REC_INTEGRATOR: return pidController.getIntegrator();
+            case REC_NEIGHBOUR_0: return pidController.getNeighbourDuty(0);
+            case REC_NEIGHBOUR_1: return pidController.getNeighbourDuty(1);
+            case REC_NEIGHBOUR_2: return pidController.getNeighbourDuty(2);
+            case REC_NEIGHBOUR_3: return pidController.getNeighbourDuty(3);
+            default: return 0.0f;
+            }
+        });
+
+        // Step response analysis runs on every tick, also the skipped ones
+        pidController.getStepAnalyser().update(measuredLux);
+        interface.reportStepResponse();
+        interface.publishPerformance(currentMillis);
+
+        // Stage a controller snapshot and the closed minute, the scheduler writes them after the step
+        snapshot.service(pidController, currentMillis);
+        metricsLog.service(metrics);
 
         // Get voltage (thread-safe)
         float voltage = luxMeter.getLdrVoltage();
@@ -133,7 +235,13 @@ void loop()
         // Stream data (serial is thread-safe by nature)
         interface.streamSerialData(dutyCycle, measuredLux, reference, voltage, currentMillis);
 
+        metrics.insertLoopTime(metrics.getControlTiming().stop(micros()));
     }
+
+    // Flash writes outside the control step: a page program only if it fits in the slack
+    // before the next sample is due, a sector erase only at steady state
+    long slack = (long)((LastUpdate_500Hz + FREQ_500Hz) * 1000UL - micros());
+    flashScheduler.service(slack > 0 ? (uint32_t)slack : 0, trackingError < FLASH_IDLE_ERROR);
 }
 
 void can_checker()
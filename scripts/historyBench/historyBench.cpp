@@ -0,0 +1,219 @@
+// Compression check and benchmark for CompressedHistory (host tool)
+//
+// Encodes representative traces with the firmware CompressedHistory and decodes them back:
+// - every log in scripts/DataLogs (duty cycle and lux as logged, real timestamps and jitter),
+//   replayed back to back until the ring has wrapped several times
+// - a synthetic 100 Hz trace: reference steps through a first-order LED/LDR response with
+//   +-2 LSB of sensor noise, the steady-state case the firmware sees most
+// Duty and lux are quantised with the same rounding as dataStorageMetrics::packDuty/packLux.
+// Every sample still held must decode bit-exact (timestamp, u, y) and in order, through
+// the cursor and through range(). Reports bytes per sample and the encode / decode cost per
+// sample (TSC cycles on x86, nanoseconds elsewhere). Exits non-zero on a mismatch.
+//
+// Build (from this folder):
+//   g++ -O2 -std=c++17 -I../../OfficeLightCanControl/lib/5dataStorageMetrics/include historyBench.cpp
+//       ../../OfficeLightCanControl/lib/5dataStorageMetrics/src/compressedHistory.cpp -o historyBench
+//
+// Usage:
+//   ./historyBench [--logs dir] [--passes n]
+
+#include <compressedHistory.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define COST_UNIT "cycles"
+static inline uint64_t now() { return __rdtsc(); }
+#else
+#define COST_UNIT "ns"
+static inline uint64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+struct trace
+{
+    std::string name;
+    std::vector<sampleRecord> samples;
+};
+
+// Same rounding as dataStorageMetrics::packDuty / packLux
+static uint16_t packDuty(float u)
+{
+    u = u < 0.0f ? 0.0f : (u > 1.0f ? 1.0f : u);
+    return (uint16_t)(u * 65535.0f + 0.5f);
+}
+
+static uint16_t packLux(float lux)
+{
+    float scaled = lux * 100.0f + 0.5f;
+    return scaled < 0.0f ? 0 : (scaled > 65535.0f ? 65535 : (uint16_t)scaled);
+}
+
+// Millis, duty and lux of a DataLogs line; the logs use three layouts:
+// "t, u, adc, V, R, lux", "t; u; ...; lux" with decimal commas, and "Millis:t, PWM:u, ..., LUX:lux"
+static bool parseLine(std::string line, int &t, float &u, float &lux)
+{
+    bool semicolons = line.find(';') != std::string::npos;
+    if (semicolons)
+    {
+        for (char &c : line)
+            c = c == ',' ? '.' : (c == ';' ? ',' : c);
+    }
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (start <= line.size())
+    {
+        size_t end = line.find(',', start);
+        if (end == std::string::npos)
+            end = line.size();
+        std::string field = line.substr(start, end - start);
+        size_t colon = field.find(':');
+        fields.push_back(colon == std::string::npos ? field : field.substr(colon + 1));
+        start = end + 1;
+    }
+    if (fields.size() < 6)
+        return false;
+    char *end;
+    t = (int)strtol(fields[0].c_str(), &end, 10);
+    if (end == fields[0].c_str())
+        return false; // Header
+    u = strtof(fields[1].c_str(), nullptr);
+    lux = strtof(fields[5].c_str(), nullptr);
+    return true;
+}
+
+static bool loadLog(const std::string &path, trace &out)
+{
+    FILE *f = fopen(path.c_str(), "r");
+    if (!f)
+        return false;
+    char buffer[256];
+    int t, last = INT32_MIN;
+    float u, lux;
+    while (fgets(buffer, sizeof(buffer), f))
+    {
+        if (parseLine(buffer, t, u, lux) && t >= last)
+        {
+            out.samples.push_back({t, packDuty(u), packLux(lux)});
+            last = t;
+        }
+    }
+    fclose(f);
+    return !out.samples.empty();
+}
+
+static trace synthetic(uint32_t count)
+{
+    trace out;
+    out.name = "synthetic 100 Hz steps";
+    uint32_t rng = 12345;
+    float u = 0.2f, y = 0.0f;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (i % 3000 == 0)
+            u = 0.1f + 0.2f * ((i / 3000) % 4); // New reference every 30 s
+        y += (u * 60.0f + 2.0f - y) * 0.05f;   // First-order response, tau about 0.2 s
+        rng = rng * 1103515245 + 12345;
+        int noise = (int)((rng >> 16) % 5) - 2; // +-2 LSB
+        out.samples.push_back({(int)(i * 10), packDuty(u), (uint16_t)(packLux(y) + noise)});
+    }
+    return out;
+}
+
+// Encode passes copies of the trace back to back, then decode what is held and compare
+static bool run(const trace &tr, uint32_t passes)
+{
+    static CompressedHistory history;
+    history = CompressedHistory();
+    std::vector<sampleRecord> input;
+    int offset = 0, span = tr.samples.back().timestamp - tr.samples.front().timestamp + 50;
+    for (uint32_t p = 0; p < passes; p++, offset += span)
+    {
+        for (const sampleRecord &s : tr.samples)
+            input.push_back({s.timestamp - tr.samples.front().timestamp + offset, s.u, s.y});
+    }
+
+    uint64_t start = now();
+    for (const sampleRecord &s : input)
+        history.append(s.timestamp, s.u, s.y);
+    double encode = (double)(now() - start) / input.size();
+
+    // Sequential decode of everything held, bit-exact against the input tail
+    uint32_t held = history.getCount();
+    size_t first = input.size() - held;
+    CompressedHistory::Cursor c = history.begin();
+    sampleRecord out;
+    uint32_t decoded = 0;
+    bool ok = true;
+    start = now();
+    while (c.next(out))
+    {
+        const sampleRecord &in = input[first + decoded];
+        ok = ok && out.timestamp == in.timestamp && out.u == in.u && out.y == in.y;
+        decoded++;
+    }
+    double decode = (double)(now() - start) / (decoded ? decoded : 1);
+    ok = ok && decoded == held && !c.overrun();
+
+    // Range reader over the middle of the held data, decimated by 3
+    int t0 = input[first + held / 3].timestamp, t1 = input[first + 2 * held / 3].timestamp;
+    CompressedHistory::Cursor r = history.getView().range(t0, t1, 3);
+    size_t i = first;
+    while (input[i].timestamp < t0)
+        i++;
+    while (r.next(out))
+    {
+        ok = ok && out.timestamp == input[i].timestamp && out.u == input[i].u && out.y == input[i].y;
+        i += 3;
+    }
+    ok = ok && input[i - 3].timestamp <= t1 && (i >= input.size() || input[i].timestamp > t1);
+
+    double bytes = (double)history.getBytesUsed() / held;
+    printf("%-24s %8zu %7u %8.2f %7.1fx %8.2fx %8.1f %8.1f  %s\n", tr.name.c_str(), input.size(), held, bytes,
+           16.0 / bytes, 5.0 / bytes, encode, decode, ok ? "exact" : "MISMATCH");
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    std::string dir = "../DataLogs";
+    uint32_t passes = 60;
+    for (int a = 1; a + 1 < argc; a += 2)
+    {
+        if (!strcmp(argv[a], "--logs"))
+            dir = argv[a + 1];
+        else if (!strcmp(argv[a], "--passes"))
+            passes = (uint32_t)atol(argv[a + 1]);
+    }
+
+    std::vector<trace> traces;
+    const char *logs[] = {"data_log_A.csv", "data_log_B.csv", "2com_adcAVG_A.csv", "previus_lux.csv"};
+    for (const char *name : logs)
+    {
+        trace tr;
+        tr.name = name;
+        if (loadLog(dir + "/" + name, tr))
+            traces.push_back(tr);
+        else
+            printf("skipped %s (not found or empty)\n", name);
+    }
+    traces.push_back(synthetic(60000));
+
+    // vs float: the original u, y, r, t arrays (16 bytes); vs packed: the 16-bit u and y with
+    // an 8-bit timestamp delta (5 bytes, reference in the event log)
+    printf("%-24s %8s %7s %8s %8s %8s %8s %8s\n", "trace", "samples", "held", "B/sample", "vs float", "vs packed",
+           "encode", "decode");
+    printf("%-24s %8s %7s %8s %8s %9s %8s %8s\n", "", "", "", "", "", "", COST_UNIT, COST_UNIT);
+    bool ok = true;
+    for (const trace &tr : traces)
+        ok = run(tr, tr.samples.size() >= 20000 ? 1 : passes) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,270 @@
+// Closed-loop comparison of the Smith predictor and event-triggered modes (host tool)
+//
+// Drives the firmware localController (real sources, called as main.cpp does) against the
+// box model of pidSweep: first-order LED/LDR lag plus a sensor dead time.
+// - smith: disturbance step on a plant with dead time, predictor off and on. Reports the
+//   IAE and peak error after the step and how often the error changes sign.
+// - event: 60 s with two reference steps, a disturbance step and sensor noise, control step
+//   on every tick and event-triggered. Reports computed ticks, IAE and the CPU time of the
+//   controller calls (eventTrigger, compute_control, housekeep) per run, TSC cycles on x86,
+//   nanoseconds elsewhere. On the board a skipped tick also saves the PWM write, the CAN
+//   announcement and the history insert, which this tool does not time.
+//
+// Build (from this folder):
+//   g++ -O2 -ffp-contract=off -std=c++17 -I../pidSweep/host
+//       -I../../OfficeLightCanControl/lib/3localController/include modeSim.cpp
+//       ../../OfficeLightCanControl/lib/3localController/src/localController.cpp
+//       ../../OfficeLightCanControl/lib/3localController/src/trajectoryGenerator.cpp
+//       ../../OfficeLightCanControl/lib/3localController/src/stepAnalyser.cpp -o modeSim
+//
+// Usage:
+//   ./modeSim [--mode smith|event|both] [--Tk k] [--Ti s] [--delay ticks] [--model-delay ticks]
+//             [--tau s] [--gain G] [--external d] [--disturbance lux] [--noise lux] [--repeat n]
+
+#include <Arduino.h>
+#include <localController.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define COST_UNIT "cycles"
+static inline uint64_t now() { return __rdtsc(); }
+#else
+#define COST_UNIT "ns"
+static inline uint64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+HostSerial Serial;
+
+static const float H = 0.01f;        // Control period (100 Hz)
+static const int MAX_PLANT_DELAY = 16;
+
+struct Plant
+{
+    float gain = 20.0f;    // LUX at full duty
+    float external = 2.0f; // Background LUX
+    float tau = 0.05f;     // LED/LDR time constant (s)
+    int delay = 3;         // Sensor dead time (ticks)
+};
+
+struct Options
+{
+    float Tk = 7.0f, Ti = 0.1f; // Firmware defaults
+    int modelDelay = -1;      // Smith model dead time, defaults to the plant dead time
+    float disturbance = 4.0f; // External illuminance step (LUX)
+    float noise = 0.05f;      // Uniform sensor noise amplitude (LUX), event run only
+    int repeat = 50;          // Event runs timed, the minimum is reported
+};
+
+struct Result
+{
+    float iae = 0.0f, peak = 0.0f;
+    int crossings = 0;
+    uint32_t computed = 0;
+    uint64_t cost = 0; // Controller calls of one run
+};
+
+// Box model with a sensor dead time, as in pidSweep
+struct BoxModel
+{
+    const Plant &plant;
+    float a, y, external;
+    float history[MAX_PLANT_DELAY];
+    int head = 0;
+
+    explicit BoxModel(const Plant &p) : plant(p), a(expf(-H / p.tau)), y(p.external), external(p.external)
+    {
+        for (float &v : history)
+            v = y;
+    }
+
+    // Sensor reading of this tick, then advance the light with the applied duty cycle
+    float read()
+    {
+        history[head] = y;
+        return history[(head - plant.delay + MAX_PLANT_DELAY) % MAX_PLANT_DELAY];
+    }
+
+    void step(float u)
+    {
+        y = a * y + (1.0f - a) * (plant.gain * u + external);
+        head = (head + 1) % MAX_PLANT_DELAY;
+    }
+};
+
+static void configure(localController &c, const Plant &plant, const Options &o)
+{
+    c.setGainAndExternal(plant.gain, plant.external);
+    c.update_localController(o.Tk, 1.0f, 0.0f, o.Ti, 0.0f, 0.1f, 10.0f);
+    c.setTrajectory(false);
+    c.setSmithDelay(o.modelDelay);
+}
+
+// Settle at 10 LUX, then a disturbance step; scored for 5 s after the step
+static Result runSmith(const Plant &plant, const Options &o, bool smith)
+{
+    const int warm = 300, scored = 500;
+    const float r = 10.0f;
+    localController c;
+    configure(c, plant, o);
+    c.setSmith(smith);
+    c.setReference(r);
+    BoxModel box(plant);
+
+    Result res;
+    float lastError = 0.0f;
+    for (int t = 0; t < warm + scored; t++)
+    {
+        if (t == warm)
+            box.external += o.disturbance;
+        float ym = box.read();
+        float u = c.compute_control();
+        c.housekeep(ym);
+        box.step(u);
+
+        if (t >= warm)
+        {
+            float e = r - box.y;
+            res.iae += fabsf(e) * H;
+            res.peak = fmaxf(res.peak, fabsf(e));
+            res.crossings += (e * lastError < 0.0f) ? 1 : 0;
+            lastError = e;
+        }
+    }
+    return res;
+}
+
+// 60 s: 10 LUX, 20 LUX at 10 s, 15 LUX at 30 s, disturbance step at 45 s, noisy sensor
+static Result runEvent(const Plant &plant, const Options &o, bool eventTriggered, uint64_t overhead)
+{
+    const int ticks = 6000;
+    localController c;
+    configure(c, plant, o);
+    c.setEventTriggered(eventTriggered);
+    c.setReference(10.0f);
+    BoxModel box(plant);
+
+    Result res;
+    uint32_t rng = 12345;
+    float u = 0.0f;
+    for (int t = 0; t < ticks; t++)
+    {
+        if (t == 1000)
+            c.setReference(20.0f);
+        if (t == 3000)
+            c.setReference(15.0f);
+        if (t == 4500)
+            box.external += o.disturbance;
+        rng = rng * 1103515245 + 12345;
+        float ym = box.read() + o.noise * (2.0f * (float)(rng >> 8) / 16777216.0f - 1.0f);
+        unsigned long millis = (unsigned long)t * 10;
+
+        uint64_t start = now();
+        if (c.eventTrigger(ym, millis))
+        {
+            u = c.compute_control();
+            c.housekeep(ym);
+            res.computed++;
+        }
+        uint64_t elapsed = now() - start;
+        res.cost += elapsed > overhead ? elapsed - overhead : 0;
+
+        box.step(u);
+        res.iae += fabsf(c.getReference() - box.y) * H;
+    }
+    return res;
+}
+
+static uint64_t timerOverhead()
+{
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 1000; i++)
+    {
+        uint64_t start = now();
+        uint64_t elapsed = now() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    Plant plant;
+    Options o;
+    std::string mode = "both";
+    for (int a = 1; a < argc; a++)
+    {
+        std::string opt = argv[a];
+        const char *val = (a + 1 < argc) ? argv[a + 1] : nullptr;
+        bool ok = val != nullptr;
+        if (opt == "--mode") mode = val ? val : "";
+        else if (opt == "--Tk") ok = ok && sscanf(val, "%f", &o.Tk) == 1;
+        else if (opt == "--Ti") ok = ok && sscanf(val, "%f", &o.Ti) == 1 && o.Ti > 0;
+        else if (opt == "--delay") ok = ok && sscanf(val, "%d", &plant.delay) == 1 && plant.delay >= 0 && plant.delay < MAX_PLANT_DELAY;
+        else if (opt == "--model-delay") ok = ok && sscanf(val, "%d", &o.modelDelay) == 1;
+        else if (opt == "--tau") ok = ok && sscanf(val, "%f", &plant.tau) == 1 && plant.tau > 0;
+        else if (opt == "--gain") ok = ok && sscanf(val, "%f", &plant.gain) == 1;
+        else if (opt == "--external") ok = ok && sscanf(val, "%f", &plant.external) == 1;
+        else if (opt == "--disturbance") ok = ok && sscanf(val, "%f", &o.disturbance) == 1;
+        else if (opt == "--noise") ok = ok && sscanf(val, "%f", &o.noise) == 1;
+        else if (opt == "--repeat") ok = ok && sscanf(val, "%d", &o.repeat) == 1 && o.repeat > 0;
+        else ok = false;
+        if (!ok)
+        {
+            fprintf(stderr, "bad option %s (see the header of modeSim.cpp)\n", opt.c_str());
+            return 1;
+        }
+        a++;
+    }
+    if (o.modelDelay < 0)
+        o.modelDelay = plant.delay;
+    if (mode != "smith" && mode != "event" && mode != "both")
+    {
+        fprintf(stderr, "unknown mode %s\n", mode.c_str());
+        return 1;
+    }
+
+    printf("plant: G %.1f, d %.1f LUX, tau %.0f ms, dead time %d ticks; Tk %g, Ti %g\n", plant.gain,
+           plant.external, plant.tau * 1000.0f, plant.delay, o.Tk, o.Ti);
+
+    if (mode != "event")
+    {
+        printf("\nsmith: %+.1f LUX disturbance at 10 LUX, 5 s scored, model dead time %d ticks\n", o.disturbance,
+               o.modelDelay);
+        printf("%-10s %10s %10s %10s\n", "predictor", "IAE[LUX*s]", "peak[LUX]", "crossings");
+        for (int smith = 0; smith <= 1; smith++)
+        {
+            Result res = runSmith(plant, o, smith);
+            printf("%-10s %10.3f %10.3f %10d\n", smith ? "on" : "off", res.iae, res.peak, res.crossings);
+        }
+    }
+
+    if (mode != "smith")
+    {
+        uint64_t overhead = timerOverhead();
+        printf("\nevent: 60 s, steps 10-20-15 LUX, %+.1f LUX disturbance, +-%.2f LUX noise, best of %d runs\n",
+               o.disturbance, o.noise, o.repeat);
+        printf("%-10s %8s %10s %12s %12s\n", "trigger", "computed", "IAE[LUX*s]", "controller", "per tick");
+        printf("%-10s %8s %10s %12s %12s\n", "", "", "", COST_UNIT, COST_UNIT);
+        uint64_t costs[2];
+        for (int event = 0; event <= 1; event++)
+        {
+            Result best = runEvent(plant, o, event, overhead);
+            for (int k = 1; k < o.repeat; k++)
+            {
+                Result res = runEvent(plant, o, event, overhead);
+                best.cost = res.cost < best.cost ? res.cost : best.cost;
+            }
+            costs[event] = best.cost;
+            printf("%-10s %8u %10.3f %12llu %12.1f\n", event ? "event" : "every", best.computed, best.iae,
+                   (unsigned long long)best.cost, (double)best.cost / 6000.0);
+        }
+        printf("controller time saved: %.0f %%\n", costs[0] ? 100.0 * (1.0 - (double)costs[1] / costs[0]) : 0.0);
+    }
+    return 0;
+}
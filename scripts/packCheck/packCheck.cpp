@@ -0,0 +1,119 @@
+// Round-trip check of the packed sample history (host tool)
+//
+// Feeds the firmware dataStorageMetrics with duty cycles sweeping [0, 1], lux sweeping the
+// stored range [0, 655.35] and a reference that changes on every sample, then reads the
+// samples back through the same API the exporters use (history cursor + unpackDuty /
+// unpackLux, reference from the event log). The sweeps use steps that are not multiples of
+// the quantisation step, so every rounding position is hit. The maximum error must stay
+// within half a step (1/131070 duty, 0.005 LUX) plus float rounding, timestamps and the
+// reference must come back exact, and lux beyond the range must clamp to 655.35.
+// Exits non-zero on failure.
+//
+// Build (from this folder):
+//   g++ -O2 -std=c++17 -I../pidSweep/host -I../../OfficeLightCanControl/lib/5dataStorageMetrics/include
+//       packCheck.cpp ../../OfficeLightCanControl/lib/5dataStorageMetrics/src/dataStorageMetrics.cpp
+//       ../../OfficeLightCanControl/lib/5dataStorageMetrics/src/compressedHistory.cpp
+//       ../../OfficeLightCanControl/lib/5dataStorageMetrics/src/eventLog.cpp
+//       ../../OfficeLightCanControl/lib/5dataStorageMetrics/src/performanceMonitor.cpp
+//       ../../OfficeLightCanControl/lib/5dataStorageMetrics/src/quantileSketch.cpp
+//       ../../OfficeLightCanControl/lib/5dataStorageMetrics/src/loopTiming.cpp -o packCheck
+//
+// Usage:
+//   ./packCheck [--samples n]
+
+#include <Arduino.h>
+#include <dataStorageMetrics.h>
+
+#include <cstring>
+#include <vector>
+
+HostSerial Serial;
+
+static const float DUTY_STEP = 1.0f / 65535.0f; // Quantisation steps of the packed format
+static const float LUX_STEP = 0.01f;
+static const float LUX_RANGE = 655.35f;
+static const int PERIOD_MS = 10;
+static const uint32_t BATCH = 4096; // Samples read back at a time, well inside the history
+
+struct sample
+{
+    int t;
+    float u, y;
+};
+
+int main(int argc, char **argv)
+{
+    uint32_t samples = 1000000;
+    for (int a = 1; a + 1 < argc; a += 2)
+    {
+        if (!strcmp(argv[a], "--samples"))
+            samples = (uint32_t)atol(argv[a + 1]);
+    }
+
+    static dataStorageMetrics metrics;
+    std::vector<sample> batch;
+    double uError = 0.0, yError = 0.0;
+    uint32_t failures = 0, checked = 0, clamped = 0;
+    int t = 0;
+
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        // Sawtooth sweeps with steps of 0.37 and 0.61 quantisation steps (triangular u avoids
+        // one-sample jumps over the full range dominating the varint sizes)
+        float phase = fmodf(i * 0.37f * DUTY_STEP * 2.0f, 2.0f);
+        float u = phase <= 1.0f ? phase : 2.0f - phase;
+        float y = fmodf(i * 0.61f * LUX_STEP, LUX_RANGE);
+        float r = 1.0f + (float)(i % 60000) * 0.01f; // Never equal two samples in a row
+        if (i % 997 == 0)
+        {
+            y = LUX_RANGE + 1.0f + (float)(i % 1000); // Out of range, must clamp
+        }
+        t += PERIOD_MS;
+        metrics.insertValues(u, y, r, t);
+        batch.push_back({t, u, y});
+
+        // Reference: stored exactly on change, the newest event is this sample
+        const EventLog &events = metrics.getEventLog();
+        const eventRecord &e = events.get(events.getCount() - 1);
+        if (e.type != EVENT_REFERENCE || e.value != r || e.timestamp != t)
+        {
+            if (failures++ < 10)
+                printf("FAIL reference %.2f at %d: got %.2f at %d\n", r, t, e.value, e.timestamp);
+        }
+
+        if (batch.size() < BATCH && i + 1 < samples)
+            continue;
+
+        // Read the batch back through a history cursor
+        CompressedHistory::View view = metrics.getHistoryView();
+        CompressedHistory::Cursor c = view.begin(view.getCount() - batch.size());
+        sampleRecord s;
+        for (const sample &in : batch)
+        {
+            if (!c.next(s) || s.timestamp != in.t)
+            {
+                if (failures++ < 10)
+                    printf("FAIL sample at %d missing or out of order\n", in.t);
+                break;
+            }
+            double du = fabs((double)dataStorageMetrics::unpackDuty(s.u) - in.u);
+            double dy = (double)dataStorageMetrics::unpackLux(s.y) - (in.y < LUX_RANGE ? in.y : LUX_RANGE);
+            if (in.y > LUX_RANGE)
+                clamped += s.y == 65535;
+            else
+                yError = fmax(yError, fabs(dy));
+            uError = fmax(uError, du);
+            checked++;
+        }
+        batch.clear();
+    }
+
+    // Half a step, plus the float rounding of the value (ulp of 655 is 6e-5 LUX)
+    double uLimit = 0.5 * DUTY_STEP + 1e-7, yLimit = 0.5 * LUX_STEP + 1e-4;
+    bool ok = failures == 0 && uError <= uLimit && yError <= yLimit && clamped == samples / 997 + 1;
+    printf("%u samples checked, %u out of range clamped\n", checked, clamped);
+    printf("max error: duty %.3g (limit %.3g), lux %.5f LUX (limit %.5f), reference exact\n", uError, uLimit,
+           yError, yLimit);
+    printf("%s\n", ok ? "OK" : "FAIL");
+    return ok ? 0 : 1;
+}
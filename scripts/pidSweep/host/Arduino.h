@@ -0,0 +1,25 @@
+// Minimal Arduino shim so the firmware controller sources compile on the host (pidSweep and the other host tools in scripts/)
+#ifndef PIDSWEEP_HOST_ARDUINO_H
+#define PIDSWEEP_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+#define PI 3.1415926535897932384626433832795
+
+struct HostSerial
+{
+    void println(const char *s) { fprintf(stderr, "%s\n", s); }
+    template <class... A>
+    void printf(const char *f, A... a) { fprintf(stderr, f, a...); }
+};
+extern HostSerial Serial;
+
+template <class T, class L, class H>
+T constrain(T x, L low, H high)
+{
+    return x < low ? low : (x > high ? high : x);
+}
+
+#endif
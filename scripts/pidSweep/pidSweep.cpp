@@ -0,0 +1,431 @@
+// Batch closed-loop simulator for localController parameter sweeps (host tool)
+//
+// Every lane is one (Tk, b, Ti, Tt) combination driving its own copy of the box model
+// (first-order LED/LDR lag plus sensor dead time). Lanes are stored as structure of arrays
+// and stepped in blocks so the per-tick loop over lanes vectorises; blocks are spread over
+// all cores. Each lane settles at r0, then gets a step to r1 and is scored on settling time,
+// overshoot, energy and flicker (same definitions as dataStorageMetrics).
+//
+// The lane kernel is the firmware PID path (STRATEGY_PID, trajectory off, feedforward,
+// back-calculation anti-windup, disturbance observer) written out per lane. Before the sweep
+// a sample of lanes is replayed through the real localController sources and the duty cycle
+// traces must match bit for bit, otherwise the tool stops.
+//
+// Build (from this folder):
+//   g++ -O3 -march=native -ffp-contract=off -std=c++17 -pthread -Ihost
+//       -I../../OfficeLightCanControl/lib/3localController/include pidSweep.cpp
+//       ../../OfficeLightCanControl/lib/3localController/src/localController.cpp
+//       ../../OfficeLightCanControl/lib/3localController/src/trajectoryGenerator.cpp
+//       ../../OfficeLightCanControl/lib/3localController/src/stepAnalyser.cpp -o pidSweep
+//   (-ffp-contract=off keeps FMA contraction out, the RP2040 has none)
+//
+// Usage:
+//   ./pidSweep [--Tk min:max:n] [--b min:max:n] [--Ti min:max:n] [--Tt min:max:n]
+//              [--gain G] [--external d] [--tau s] [--delay ticks] [--r0 lux] [--r1 lux]
+//              [--time s] [--sort settle|overshoot|energy|flicker] [--top n] [--csv file]
+
+#include <Arduino.h>
+#include <localController.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+HostSerial Serial;
+
+static const float H = 0.01f;               // Control period (100 Hz)
+static const float LED_MAX_POWER = 0.099f;  // W, as in dataStorageMetrics
+static const int HISTORY_MASK = 15;         // Smith/observer delay line of localController
+static const int BLOCK = 256;               // Lanes stepped together (fits L1/L2)
+static const int MAX_PLANT_DELAY = 16;
+
+struct Range
+{
+    float min, max;
+    int n;
+    float at(int i) const { return n > 1 ? min + (max - min) * i / (n - 1) : min; }
+};
+
+struct Plant
+{
+    float gain = 20.0f;      // LUX at full duty
+    float external = 2.0f;   // Background LUX
+    float tau = 0.05f;       // LED/LDR time constant (s)
+    int delay = 2;           // Sensor dead time (ticks)
+};
+
+struct Scenario
+{
+    float r0 = 10.0f, r1 = 15.0f; // Reference before and after the step
+    int warmTicks = 300;          // Ticks at r0 before the step
+    int stepTicks = 500;          // Ticks scored after the step
+};
+
+// Controller constants shared by all lanes, computed with the same expressions as
+// localController::constantCalc
+struct Shared
+{
+    float gain, external;
+    float plantTau, plantA, dobAlpha;
+    int smithDelay;
+};
+
+// Structure of arrays, one entry per lane
+struct Lanes
+{
+    int n = 0;
+    // Parameters
+    std::vector<float> Tk, b, Ti, Tt, bi, kaw, ao;
+    // Controller state
+    std::vector<float> I, y, ext, xLed, uPrev;
+    std::vector<float> hist;       // [HISTORY_MASK + 1][n]
+    // Plant state
+    std::vector<float> yTrue;
+    std::vector<float> plantHist;  // [MAX_PLANT_DELAY][n]
+    // Scores
+    std::vector<float> settle, overshoot, energy, flicker;
+
+    void resize(int count)
+    {
+        n = count;
+        for (auto *v : {&Tk, &b, &Ti, &Tt, &bi, &kaw, &ao, &I, &y, &ext, &xLed, &uPrev, &yTrue,
+                        &settle, &overshoot, &energy, &flicker})
+        {
+            v->assign(n, 0.0f);
+        }
+        hist.assign((HISTORY_MASK + 1) * (size_t)n, 0.0f);
+        plantHist.assign(MAX_PLANT_DELAY * (size_t)n, 0.0f);
+    }
+};
+
+static Shared makeShared(const Plant &plant)
+{
+    // Same defaults and expressions as localController (h = 0.01, tau = 0.05, 1 Hz observer)
+    float h = H;
+    float plantTau = 0.05f;
+    float dobBandwidth = 1.0f;
+
+    Shared s;
+    s.gain = plant.gain;
+    s.external = plant.external;
+    s.plantTau = plantTau;
+    s.plantA = (plantTau > 0) ? exp(-h / plantTau) : 0.0f;
+    s.dobAlpha = 1.0f - exp(-2.0f * PI * dobBandwidth * h);
+    s.smithDelay = 2;
+    return s;
+}
+
+static void setParameters(Lanes &l, int i, float Tk, float b, float Ti, float Tt)
+{
+    float h = H;
+    l.Tk[i] = Tk;
+    l.b[i] = b;
+    l.Ti[i] = Ti;
+    l.Tt[i] = Tt;
+    l.bi[i] = Tk * h / Ti; // _bi, also the integral gain of compute_control
+    l.kaw[i] = 1 / Tt;     // K_aw
+    l.ao[i] = h / Tt;      // _ao
+}
+
+// Simulate lanes [begin, end). If trace is given, the duty cycle of every tick is stored
+// as trace[tick * (end - begin) + lane - begin]
+static void simulate(Lanes &l, int begin, int end, const Shared &s, const Plant &plant,
+                     const Scenario &sc, float *trace)
+{
+    const int n = l.n;
+    const int ticks = sc.warmTicks + sc.stepTicks;
+    const float h = H;
+    const float plantA = expf(-h / plant.tau);
+    const float stepSize = fabsf(sc.r1 - sc.r0);
+    const float band = 0.02f * stepSize;
+
+    for (int b0 = begin; b0 < end; b0 += BLOCK)
+    {
+        const int b1 = std::min(b0 + BLOCK, end);
+
+        float *Tk = &l.Tk[0], *bw = &l.b[0], *bi = &l.bi[0], *kaw = &l.kaw[0], *ao = &l.ao[0];
+        float *I = &l.I[0], *y = &l.y[0], *ext = &l.ext[0], *xLed = &l.xLed[0], *uPrev = &l.uPrev[0];
+        float *yTrue = &l.yTrue[0];
+
+        // Score accumulators for this block
+        float uM1[BLOCK], uM2[BLOCK], yPeak[BLOCK], yLow[BLOCK], lastOut[BLOCK], eSum[BLOCK], fSum[BLOCK];
+
+        // Initial state after setGainAndExternal (observer starts at the calibrated background)
+        for (int i = b0; i < b1; i++)
+        {
+            I[i] = 0.0f;
+            y[i] = 0.0f;
+            ext[i] = s.external;
+            xLed[i] = 0.0f;
+            uPrev[i] = 0.0f;
+            yTrue[i] = plant.external;
+            for (int k = 0; k <= HISTORY_MASK; k++)
+                l.hist[(size_t)k * n + i] = 0.0f;
+            for (int k = 0; k < MAX_PLANT_DELAY; k++)
+                l.plantHist[(size_t)k * n + i] = plant.external;
+            int j = i - b0;
+            uM1[j] = uM2[j] = 0.0f;
+            yPeak[j] = -1e30f;
+            yLow[j] = 1e30f;
+            lastOut[j] = 0.0f;
+            eSum[j] = fSum[j] = 0.0f;
+        }
+
+        int head = 0;      // Observer delay line head (_smithHead)
+        int plantHead = 0; // Sensor delay line head
+
+        for (int t = 0; t < ticks; t++)
+        {
+            const bool scored = t >= sc.warmTicks;
+            const float rt = scored ? sc.r1 : sc.r0;
+            const float *yDelayed = &l.plantHist[(size_t)((plantHead - plant.delay + MAX_PLANT_DELAY) % MAX_PLANT_DELAY) * n];
+            float *yNow = &l.plantHist[(size_t)plantHead * n];
+            const float *xDelayed = &l.hist[(size_t)((head - s.smithDelay) & HISTORY_MASK) * n];
+            float *xNew = &l.hist[(size_t)((head + 1) & HISTORY_MASK) * n];
+            float *tr = trace ? trace + (size_t)t * (end - begin) - begin : nullptr;
+
+            for (int i = b0; i < b1; i++)
+            {
+                // Sensor reading of this tick (before the new duty is applied)
+                yNow[i] = yTrue[i];
+                float ym = yDelayed[i];
+
+                // compute_control -> compute_pi(true), feedback on, no cascade
+                float P = Tk[i] * (bw[i] * rt - y[i]);
+                float ut = 0;
+                float uff = (4095.0f / s.gain) * (rt + s.plantTau * 0.0f - ext[i]);
+                uff -= (4095.0f / s.gain) * (0.0f - 0.0f); // Neighbour feedforward, no neighbours
+                ut = P + I[i];
+                ut = ut + uff;
+                float uSat = ut;
+                uSat = (ut < 0) ? 0.0f : uSat;
+                uSat = (ut > 4095) ? 4095.0f : uSat;
+                I[i] += bi[i] * (rt - y[i]) + kaw[i] * ((uSat - ut) * h + 0.0f);
+                float u = uSat / 4095;
+                uPrev[i] = u;
+
+                // housekeep(ym) with the observer step
+                y[i] = ym;
+                float error = rt - ym;
+                I[i] += bi[i] * error + ao[i] * 0.0f;
+                float dRaw = ym - xDelayed[i];
+                ext[i] += s.dobAlpha * (dRaw - ext[i]);
+                xLed[i] += (1.0f - s.plantA) * (s.gain * u - xLed[i]);
+                xNew[i] = xLed[i];
+
+                // Box model
+                yTrue[i] = plantA * yTrue[i] + (1.0f - plantA) * (plant.gain * u + plant.external);
+
+                if (tr)
+                    tr[i] = u;
+
+                // Scores (branch free so the loop stays vectorisable)
+                int j = i - b0;
+                float d1 = u - uM1[j], d2 = uM1[j] - uM2[j];
+                float flick = (d1 * d2 < 0) ? fabsf(d1) + fabsf(d2) : 0.0f;
+                bool outside = fabsf(yTrue[i] - sc.r1) > band;
+                fSum[j] += (scored && t >= sc.warmTicks + 2) ? flick : 0.0f;
+                eSum[j] += scored ? u * h : 0.0f;
+                yPeak[j] = scored ? fmaxf(yPeak[j], yTrue[i]) : yPeak[j];
+                yLow[j] = scored ? fminf(yLow[j], yTrue[i]) : yLow[j];
+                lastOut[j] = (scored && outside) ? (float)(t - sc.warmTicks + 1) : lastOut[j];
+                uM2[j] = uM1[j];
+                uM1[j] = u;
+            }
+
+            head = (head + 1) & HISTORY_MASK;
+            plantHead = (plantHead + 1) % MAX_PLANT_DELAY;
+        }
+
+        for (int i = b0; i < b1; i++)
+        {
+            int j = i - b0;
+            float over = (sc.r1 > sc.r0) ? yPeak[j] - sc.r1 : sc.r1 - yLow[j];
+            l.settle[i] = lastOut[j] * h;
+            l.overshoot[i] = stepSize > 0 ? std::max(0.0f, over) / stepSize * 100.0f : 0.0f;
+            l.energy[i] = eSum[j] * LED_MAX_POWER;
+            l.flicker[i] = fSum[j] / sc.stepTicks;
+        }
+    }
+}
+
+// Replay lanes through the firmware localController and compare duty cycles bit for bit
+static bool verify(Lanes &l, const Shared &s, const Plant &plant, const Scenario &sc, int samples)
+{
+    const int ticks = sc.warmTicks + sc.stepTicks;
+    const float plantA = expf(-H / plant.tau);
+    std::vector<int> pick;
+    for (int k = 0; k < samples; k++)
+        pick.push_back((int)((long long)k * (l.n - 1) / std::max(1, samples - 1)));
+
+    // Kernel traces of the picked lanes
+    Lanes sub;
+    sub.resize((int)pick.size());
+    for (size_t k = 0; k < pick.size(); k++)
+        setParameters(sub, (int)k, l.Tk[pick[k]], l.b[pick[k]], l.Ti[pick[k]], l.Tt[pick[k]]);
+    std::vector<float> trace((size_t)ticks * sub.n);
+    simulate(sub, 0, sub.n, s, plant, sc, trace.data());
+
+    for (int k = 0; k < sub.n; k++)
+    {
+        localController c;
+        c.setGainAndExternal(plant.gain, s.external);
+        c.update_localController(sub.Tk[k], sub.b[k], 0.0f, sub.Ti[k], 0.0f, sub.Tt[k], 10.0f);
+        c.setTrajectory(false);
+        c.setReference(sc.r0);
+
+        float yTrue = plant.external;
+        float plantHist[MAX_PLANT_DELAY];
+        for (float &v : plantHist)
+            v = plant.external;
+        int plantHead = 0;
+
+        for (int t = 0; t < ticks; t++)
+        {
+            if (t == sc.warmTicks)
+                c.setReference(sc.r1);
+            plantHist[plantHead] = yTrue;
+            float ym = plantHist[(plantHead - plant.delay + MAX_PLANT_DELAY) % MAX_PLANT_DELAY];
+            float u = c.compute_control();
+            c.housekeep(ym);
+            yTrue = plantA * yTrue + (1.0f - plantA) * (plant.gain * u + plant.external);
+            plantHead = (plantHead + 1) % MAX_PLANT_DELAY;
+
+            float uk = trace[(size_t)t * sub.n + k];
+            if (memcmp(&u, &uk, sizeof(float)) != 0)
+            {
+                fprintf(stderr, "mismatch lane Tk=%g b=%g Ti=%g Tt=%g tick %d: firmware %.9g kernel %.9g\n",
+                        sub.Tk[k], sub.b[k], sub.Ti[k], sub.Tt[k], t, u, uk);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool parseRange(const char *s, Range &r)
+{
+    return sscanf(s, "%f:%f:%d", &r.min, &r.max, &r.n) == 3 && r.n > 0;
+}
+
+int main(int argc, char **argv)
+{
+    Range rTk{1.0f, 20.0f, 16}, rB{0.2f, 1.0f, 8}, rTi{0.05f, 1.0f, 16}, rTt{0.02f, 1.0f, 8};
+    Plant plant;
+    Scenario sc;
+    std::string sortKey = "settle", csvPath;
+    int top = 20;
+    float seconds = 5.0f;
+
+    for (int a = 1; a < argc; a++)
+    {
+        std::string opt = argv[a];
+        const char *val = (a + 1 < argc) ? argv[a + 1] : nullptr;
+        bool ok = val != nullptr;
+        if (opt == "--Tk") ok = ok && parseRange(val, rTk);
+        else if (opt == "--b") ok = ok && parseRange(val, rB);
+        else if (opt == "--Ti") ok = ok && parseRange(val, rTi);
+        else if (opt == "--Tt") ok = ok && parseRange(val, rTt);
+        else if (opt == "--gain") ok = ok && sscanf(val, "%f", &plant.gain) == 1;
+        else if (opt == "--external") ok = ok && sscanf(val, "%f", &plant.external) == 1;
+        else if (opt == "--tau") ok = ok && sscanf(val, "%f", &plant.tau) == 1;
+        else if (opt == "--delay") ok = ok && sscanf(val, "%d", &plant.delay) == 1 && plant.delay >= 0 && plant.delay < MAX_PLANT_DELAY;
+        else if (opt == "--r0") ok = ok && sscanf(val, "%f", &sc.r0) == 1;
+        else if (opt == "--r1") ok = ok && sscanf(val, "%f", &sc.r1) == 1;
+        else if (opt == "--time") ok = ok && sscanf(val, "%f", &seconds) == 1 && seconds > 0;
+        else if (opt == "--sort") sortKey = val ? val : "";
+        else if (opt == "--top") ok = ok && sscanf(val, "%d", &top) == 1;
+        else if (opt == "--csv") csvPath = val ? val : "";
+        else ok = false;
+        if (!ok)
+        {
+            fprintf(stderr, "bad option %s (see the header of pidSweep.cpp)\n", opt.c_str());
+            return 1;
+        }
+        a++;
+    }
+    sc.stepTicks = (int)(seconds / H + 0.5f);
+
+    Lanes lanes;
+    lanes.resize(rTk.n * rB.n * rTi.n * rTt.n);
+    int i = 0;
+    for (int a = 0; a < rTk.n; a++)
+        for (int b = 0; b < rB.n; b++)
+            for (int c = 0; c < rTi.n; c++)
+                for (int d = 0; d < rTt.n; d++)
+                    setParameters(lanes, i++, rTk.at(a), rB.at(b), rTi.at(c), rTt.at(d));
+
+    Shared shared = makeShared(plant);
+    if (!verify(lanes, shared, plant, sc, std::min(lanes.n, 32)))
+    {
+        fprintf(stderr, "kernel does not match localController, fix the kernel before trusting the sweep\n");
+        return 2;
+    }
+
+    // Spread whole blocks over the cores
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int blocks = (lanes.n + BLOCK - 1) / BLOCK;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int w = 0; w < threads; w++)
+    {
+        int begin = (int)((long long)blocks * w / threads) * BLOCK;
+        int end = std::min(lanes.n, (int)((long long)blocks * (w + 1) / threads) * BLOCK);
+        if (begin < end)
+            pool.emplace_back(simulate, std::ref(lanes), begin, end, std::cref(shared), std::cref(plant), std::cref(sc), nullptr);
+    }
+    for (auto &th : pool)
+        th.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double steps = (double)lanes.n * (sc.warmTicks + sc.stepTicks);
+
+    printf("%d lanes x %d ticks on %d threads: %.3f s, %.2e controller steps/s (32 lanes bit-exact)\n",
+           lanes.n, sc.warmTicks + sc.stepTicks, threads, elapsed, steps / elapsed);
+
+    const std::vector<float> *key = &lanes.settle;
+    if (sortKey == "overshoot") key = &lanes.overshoot;
+    else if (sortKey == "energy") key = &lanes.energy;
+    else if (sortKey == "flicker") key = &lanes.flicker;
+    else if (sortKey != "settle")
+    {
+        fprintf(stderr, "unknown sort key %s\n", sortKey.c_str());
+        return 1;
+    }
+
+    // Ties (e.g. many lanes with 0 % overshoot) are broken by settling time
+    std::vector<int> order(lanes.n);
+    for (int k = 0; k < lanes.n; k++)
+        order[k] = k;
+    std::stable_sort(order.begin(), order.end(), [&](int x, int y) {
+        if ((*key)[x] != (*key)[y])
+            return (*key)[x] < (*key)[y];
+        return lanes.settle[x] < lanes.settle[y];
+    });
+
+    printf("%8s %6s %8s %8s %10s %12s %10s %12s\n", "Tk", "b", "Ti", "Tt", "settle[s]", "overshoot[%]", "energy[J]", "flicker[1/s]");
+    for (int k = 0; k < std::min(top, lanes.n); k++)
+    {
+        int j = order[k];
+        printf("%8.3f %6.3f %8.3f %8.3f %10.2f %12.2f %10.4f %12.6f\n", lanes.Tk[j], lanes.b[j], lanes.Ti[j], lanes.Tt[j],
+               lanes.settle[j], lanes.overshoot[j], lanes.energy[j], lanes.flicker[j]);
+    }
+
+    if (!csvPath.empty())
+    {
+        FILE *f = fopen(csvPath.c_str(), "w");
+        if (!f)
+        {
+            fprintf(stderr, "cannot open %s\n", csvPath.c_str());
+            return 1;
+        }
+        fprintf(f, "Tk,b,Ti,Tt,settle,overshoot,energy,flicker\n");
+        for (int j : order)
+            fprintf(f, "%g,%g,%g,%g,%g,%g,%g,%g\n", lanes.Tk[j], lanes.b[j], lanes.Ti[j], lanes.Tt[j],
+                    lanes.settle[j], lanes.overshoot[j], lanes.energy[j], lanes.flicker[j]);
+        fclose(f);
+    }
+    return 0;
+}
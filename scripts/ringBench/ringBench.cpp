@@ -0,0 +1,281 @@
+// Host checks and benchmark for Ring / SpscRing (lib/5dataStorageMetrics/include/ring.h)
+//
+// 1. Model check: random push / pushOverwrite / pop / discard / batch / span / index
+//    operations on a Ring compared against a std::deque after every step.
+// 2. SPSC stress: a producer thread pushes a counting sequence with push and pushBatch while
+//    the consumer drains it with pop, popBatch and getSpan + consume; any gap, duplicate or
+//    reordered value stops the tool. Run it on a multi-core host (and under
+//    -fsanitize=thread for the memory ordering).
+// 3. Benchmark: history-style overwrite and indexed reads on a Ring against the same buffer
+//    indexed with %, the firmware pattern before Ring. On the host the division is a few
+//    cycles; on the M0+ it is a call into the SDK divider helpers.
+//
+// Build (from this folder):
+//   g++ -O2 -std=c++17 -pthread -I../../OfficeLightCanControl/lib/5dataStorageMetrics/include
+//       ringBench.cpp -o ringBench
+//
+// Usage:
+//   ./ringBench [--items n] [--steps n]
+
+#include <ring.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <thread>
+
+static uint32_t rng = 12345;
+static uint32_t nextRandom()
+{
+    rng = rng * 1103515245 + 12345;
+    return rng >> 8;
+}
+
+// Fail and report the step
+static bool check(bool condition, const char *what, uint32_t step)
+{
+    if (!condition)
+        printf("FAIL %s at step %u\n", what, step);
+    return condition;
+}
+
+static bool modelCheck(uint32_t steps)
+{
+    static const uint32_t N = 16;
+    Ring<uint32_t, N> ring;
+    std::deque<uint32_t> model;
+    uint32_t value = 0;
+    uint32_t buffer[N + 4];
+
+    for (uint32_t step = 0; step < steps; step++)
+    {
+        switch (nextRandom() % 7)
+        {
+        case 0:
+            if (!check(ring.push(value) == (model.size() < N), "push", step))
+                return false;
+            if (model.size() < N)
+                model.push_back(value);
+            value++;
+            break;
+        case 1:
+            ring.pushOverwrite(value);
+            if (model.size() == N)
+                model.pop_front();
+            model.push_back(value++);
+            break;
+        case 2:
+        {
+            uint32_t out = 0;
+            bool popped = ring.pop(out);
+            if (!check(popped == !model.empty(), "pop", step) || (popped && !check(out == model.front(), "pop value", step)))
+                return false;
+            if (popped)
+                model.pop_front();
+            break;
+        }
+        case 3:
+        {
+            uint32_t n = nextRandom() % (N + 4);
+            for (uint32_t i = 0; i < n; i++)
+                buffer[i] = value + i;
+            uint32_t pushed = ring.pushBatch(buffer, n);
+            uint32_t expected = n < N - model.size() ? n : N - model.size();
+            if (!check(pushed == expected, "pushBatch", step))
+                return false;
+            for (uint32_t i = 0; i < pushed; i++)
+                model.push_back(value++);
+            break;
+        }
+        case 4:
+        {
+            uint32_t n = nextRandom() % (N + 4);
+            uint32_t popped = ring.popBatch(buffer, n);
+            uint32_t expected = n < model.size() ? n : model.size();
+            if (!check(popped == expected, "popBatch", step))
+                return false;
+            for (uint32_t i = 0; i < popped; i++)
+            {
+                if (!check(buffer[i] == model.front(), "popBatch value", step))
+                    return false;
+                model.pop_front();
+            }
+            break;
+        }
+        case 5:
+        {
+            uint32_t n = nextRandom() % 4;
+            ring.discard(n);
+            for (uint32_t i = 0; i < n && !model.empty(); i++)
+                model.pop_front();
+            break;
+        }
+        default:
+        {
+            // Both spans in order must equal the content
+            uint32_t first = 0, second = 0;
+            const uint32_t *a = ring.getSpan(0, first);
+            const uint32_t *b = ring.getSpan(1, second);
+            if (!check(first + second == model.size(), "span length", step))
+                return false;
+            for (uint32_t i = 0; i < first + second; i++)
+            {
+                if (!check((i < first ? a[i] : b[i - first]) == model[i], "span value", step))
+                    return false;
+            }
+            break;
+        }
+        }
+
+        if (!check(ring.size() == model.size(), "size", step))
+            return false;
+        for (uint32_t i = 0; i < model.size(); i++)
+        {
+            if (!check(ring[i] == model[i], "operator[]", step))
+                return false;
+        }
+        if (!model.empty() && !check(ring.back() == model.back(), "back", step))
+            return false;
+    }
+    return true;
+}
+
+static bool spscStress(uint32_t items)
+{
+    static SpscRing<uint32_t, 256> ring;
+    static std::atomic<bool> stop(false);
+    bool ok = true;
+
+    std::thread producer([items]() {
+        uint32_t state = 777, next = 0, batch[64];
+        while (next < items && !stop.load(std::memory_order_relaxed))
+        {
+            state = state * 1103515245 + 12345;
+            if ((state >> 16) & 1)
+            {
+                if (ring.push(next))
+                    next++;
+                else
+                    std::this_thread::yield();
+            }
+            else
+            {
+                uint32_t n = (state >> 20) % 64;
+                if (n > items - next)
+                    n = items - next;
+                for (uint32_t i = 0; i < n; i++)
+                    batch[i] = next + i;
+                next += ring.pushBatch(batch, n);
+            }
+        }
+    });
+
+    uint32_t state = 999, expected = 0, batch[64];
+    while (expected < items && ok)
+    {
+        state = state * 1103515245 + 12345;
+        switch ((state >> 16) % 3)
+        {
+        case 0:
+        {
+            uint32_t value;
+            if (ring.pop(value))
+                ok = value == expected++;
+            else
+                std::this_thread::yield();
+            break;
+        }
+        case 1:
+        {
+            uint32_t n = ring.popBatch(batch, (state >> 20) % 64);
+            for (uint32_t i = 0; i < n && ok; i++)
+                ok = batch[i] == expected++;
+            break;
+        }
+        default:
+        {
+            uint32_t length;
+            const uint32_t *span = ring.getSpan(length);
+            for (uint32_t i = 0; i < length && ok; i++)
+                ok = span[i] == expected++;
+            ring.consume(length);
+            break;
+        }
+        }
+    }
+    if (!ok)
+        printf("FAIL sequence broken near item %u\n", expected);
+
+    stop = true;
+    producer.join();
+    return ok && ring.size() == 0;
+}
+
+// History buffer indexed with %, as before Ring
+struct ModuloRing
+{
+    static const uint32_t N = 1000;
+    uint32_t data[N];
+    uint32_t head = 0, count = 0;
+
+    void pushOverwrite(uint32_t value)
+    {
+        data[head] = value;
+        head = (head + 1) % N;
+        if (count < N)
+            count++;
+    }
+    uint32_t operator[](uint32_t i) const { return data[(head + N - count + i) % N]; }
+};
+
+template <typename Buffer>
+static double benchmark(Buffer &buffer, uint32_t steps, uint32_t &checksum)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t step = 0; step < steps; step++)
+    {
+        buffer.pushOverwrite(step);
+        checksum += buffer[step & 511]; // Reads spread over the buffer, as the exporters
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / steps;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t items = 10000000, steps = 1000000;
+    for (int a = 1; a < argc; a++)
+    {
+        const char *val = (a + 1 < argc) ? argv[a + 1] : nullptr;
+        bool ok = val != nullptr;
+        if (!strcmp(argv[a], "--items")) ok = ok && sscanf(val, "%u", &items) == 1;
+        else if (!strcmp(argv[a], "--steps")) ok = ok && sscanf(val, "%u", &steps) == 1;
+        else ok = false;
+        if (!ok)
+        {
+            printf("Usage: %s [--items n] [--steps n]\n", argv[0]);
+            return 2;
+        }
+        a++;
+    }
+
+    if (!modelCheck(steps))
+        return 1;
+    printf("Ring model check: %u random operations OK\n", steps);
+
+    auto start = std::chrono::steady_clock::now();
+    if (!spscStress(items))
+        return 1;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("SpscRing stress: %u items in order across two threads (%.1f M items/s)\n", items, items / seconds / 1e6);
+
+    static Ring<uint32_t, 1024> ring;
+    static ModuloRing modulo;
+    uint32_t checksum = 0;
+    double ringNs = benchmark(ring, steps * 10, checksum);
+    double moduloNs = benchmark(modulo, steps * 10, checksum);
+    printf("Overwrite + indexed read: Ring %.2f ns, %% ring %.2f ns per step (checksum %u)\n", ringNs, moduloNs, checksum);
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Limit check for the reference trajectory generator (host tool)
+//
+// Runs the firmware TrajectoryGenerator over a sweep of reference steps, and over steps whose
+// target moves again while the profile is still in motion, at the 100 Hz control period.
+// Velocity, acceleration and jerk are taken from finite differences of the position output
+// (what the controller actually sees, landing tick included) and must stay within the limits,
+// up to 1 % plus the float rounding of the position the differences amplify;
+// every profile must come to rest on its target, plain steps without overshoot (a target
+// moved back while in motion may force one). Exits non-zero on failure.
+//
+// Build (from this folder):
+//   g++ -O2 -std=c++17 -I../pidSweep/host -I../../OfficeLightCanControl/lib/3localController/include
+//       trajectoryCheck.cpp ../../OfficeLightCanControl/lib/3localController/src/trajectoryGenerator.cpp
+//       -o trajectoryCheck
+//
+// Usage:
+//   ./trajectoryCheck [--vMax v] [--aMax a] [--jMax j]
+
+#include <Arduino.h>
+#include <trajectoryGenerator.h>
+
+#include <cstring>
+
+HostSerial Serial;
+
+static const float H = 0.01f;       // Control period (100 Hz)
+static const float TOLERANCE = 1.01f; // Relative slack on the limits
+static const int SETTLE_TICKS = 1000; // Allowed on top of the travel at vMax
+
+struct Result
+{
+    float vPeak, aPeak, jPeak; // Largest |v|, |a|, |j| from finite differences
+    float overshoot;           // Largest distance past the target of a plain step (LUX)
+    float pMax;                // Largest |position|, sets the float rounding of the differences
+    int settle;                // Tick at which the profile rests on the final target (-1 if never)
+};
+
+// Step from r0 to r1, the target changes to r2 at tick change (no change if change < 0)
+static Result run(float vMax, float aMax, float jMax, float r0, float r1, float r2, int change)
+{
+    TrajectoryGenerator t(vMax, aMax, jMax);
+    t.reset(r0);
+    Result res = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1};
+    double p[3] = {r0, r0, r0}, v[2] = {0.0, 0.0}, a = 0.0;
+    float target = r1;
+    int ticks = SETTLE_TICKS + (int)((fabsf(r1 - r0) + fabsf(r2 - r1)) / (vMax * H));
+    for (int k = 0; k < ticks; k++)
+    {
+        if (k == change)
+            target = r2;
+        float out = t.update(target, H);
+
+        p[0] = p[1];
+        p[1] = p[2];
+        p[2] = out;
+        v[0] = v[1];
+        v[1] = (p[2] - p[1]) / H;
+        double aNew = (v[1] - v[0]) / H;
+        double j = (aNew - a) / H;
+        a = aNew;
+        res.vPeak = fmax(res.vPeak, fabs(v[1]));
+        res.aPeak = fmax(res.aPeak, fabs(a));
+        res.jPeak = fmax(res.jPeak, fabs(j));
+        res.pMax = fmax(res.pMax, fabs(out));
+
+        bool final = change < 0 || k >= change;
+        if (change < 0)
+        {
+            res.overshoot = fmax(res.overshoot, (out - r1) * (r1 > r0 ? 1.0f : -1.0f));
+        }
+        if (final && res.settle < 0 && out == target && t.getVelocity() == 0.0f)
+            res.settle = k;
+    }
+    return res;
+}
+
+static bool check(const Result &r, float vMax, float aMax, float jMax, const char *what)
+{
+    // The output is a float position: each sample is off by up to half an ulp, which the
+    // differences amplify by 1/h, 2/h^2 and 4/h^3 (about 30 LUX/s^3 of jerk at 100 LUX)
+    float ulp = nextafterf(r.pMax, INFINITY) - r.pMax;
+    bool ok = r.vPeak <= vMax * TOLERANCE + ulp / H && r.aPeak <= aMax * TOLERANCE + 2.0f * ulp / (H * H) &&
+              r.jPeak <= jMax * TOLERANCE + 4.0f * ulp / (H * H * H) && r.overshoot <= 1e-3f && r.settle >= 0;
+    if (!ok)
+        printf("FAIL %s: v %.2f a %.2f j %.1f overshoot %.4f settle %d\n", what, r.vPeak, r.aPeak, r.jPeak, r.overshoot, r.settle);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    float vMax = 50.0f, aMax = 200.0f, jMax = 2000.0f; // Firmware defaults
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "--vMax")) vMax = atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--aMax")) aMax = atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--jMax")) jMax = atof(argv[i + 1]);
+    }
+
+    int failures = 0, runs = 0;
+    Result worst = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0};
+    char what[96];
+
+    // Steps up and down over three decades of size
+    for (float size = 0.01f; size <= 200.0f; size *= 1.25f)
+    {
+        for (int dir = -1; dir <= 1; dir += 2)
+        {
+            float r0 = 100.0f, r1 = r0 + dir * size;
+            Result r = run(vMax, aMax, jMax, r0, r1, r1, -1);
+            snprintf(what, sizeof(what), "step %.2f -> %.2f", r0, r1);
+            failures += !check(r, vMax, aMax, jMax, what);
+            runs++;
+            worst.vPeak = fmax(worst.vPeak, r.vPeak);
+            worst.aPeak = fmax(worst.aPeak, r.aPeak);
+            worst.jPeak = fmax(worst.jPeak, r.jPeak);
+            worst.overshoot = fmax(worst.overshoot, r.overshoot);
+            if (dir > 0 && (fabsf(size - 10.0f) < 1.2f || fabsf(size - 100.0f) < 12.0f))
+                printf("step %6.2f LUX: settles in %d ticks\n", size, r.settle);
+        }
+    }
+
+    // Target moved while in motion: further, back, and reversed past the start
+    const float moves[] = {5.0f, -5.0f, -20.0f, 30.0f};
+    for (float move : moves)
+    {
+        for (int change = 1; change < 100; change += 3)
+        {
+            Result r = run(vMax, aMax, jMax, 10.0f, 20.0f, 20.0f + move, change);
+            snprintf(what, sizeof(what), "10 -> 20 -> %.0f at tick %d", 20.0f + move, change);
+            failures += !check(r, vMax, aMax, jMax, what);
+            runs++;
+            worst.vPeak = fmax(worst.vPeak, r.vPeak);
+            worst.aPeak = fmax(worst.aPeak, r.aPeak);
+            worst.jPeak = fmax(worst.jPeak, r.jPeak);
+        }
+    }
+
+    printf("%d profiles, %d failed; peaks v %.2f/%.0f a %.2f/%.0f j %.1f/%.0f, overshoot %.5f\n", runs, failures,
+           worst.vPeak, vMax, worst.aPeak, aMax, worst.jPeak, jMax, worst.overshoot);
+    return failures ? 1 : 0;
+}